@@ -0,0 +1,107 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "setting.h"
+#include "piece.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+    One bit per square. Squares use the same numbering as board->pieces
+    (row * DIM_X + col), so bit 0 is a8 (top left on screen) and bit 63 is h1.
+    Moving "up" the screen (white's forward direction) is a shift right by 8.
+*/
+typedef uint64_t Bitboard_t;
+
+#define SQUARE_COUNT (DIM_X * DIM_Y)
+#define SQUARE(row, col) ((row) * DIM_X + (col))
+#define ROW_OF(sq) ((sq) >> 3)
+#define COL_OF(sq) ((sq) & 7)
+#define BIT(sq) (1ULL << (sq))
+
+#define FILE_A_BB 0x0101010101010101ULL
+#define FILE_H_BB (FILE_A_BB << 7)
+#define ROW_0_BB  0x00000000000000FFULL   // rank 8
+#define ROW_7_BB  (ROW_0_BB << 56)        // rank 1
+
+// index into Board_t.bitboards, independent of the letter values in PieceType_t
+typedef enum PieceIndex {
+    PAWN_IDX = 0,
+    KNIGHT_IDX,
+    BISHOP_IDX,
+    ROOK_IDX,
+    QUEEN_IDX,
+    KING_IDX,
+    PIECE_IDX_COUNT
+} PieceIndex_t;
+
+typedef enum ColorIndex {
+    WHITE_IDX = 0,
+    BLACK_IDX,
+    COLOR_IDX_COUNT
+} ColorIndex_t;
+
+static inline PieceIndex_t PieceToIndex(PieceType_t type) {
+    switch(type) {
+        case PAWN:   return PAWN_IDX;
+        case KNIGHT: return KNIGHT_IDX;
+        case BISHOP: return BISHOP_IDX;
+        case ROOK:   return ROOK_IDX;
+        case QUEEN:  return QUEEN_IDX;
+        case KING:   return KING_IDX;
+        default:     return PIECE_IDX_COUNT;
+    }
+}
+
+static inline PieceType_t IndexToPiece(PieceIndex_t index) {
+    static const PieceType_t types[PIECE_IDX_COUNT] = { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
+    return types[index];
+}
+
+static inline ColorIndex_t ColorToIndex(PieceColor_t color) {
+    return (color == WHITE) ? WHITE_IDX : BLACK_IDX;
+}
+
+static inline int PopCount(Bitboard_t bb) {
+#if defined(_MSC_VER)
+    return (int)__popcnt64(bb);
+#else
+    return __builtin_popcountll(bb);
+#endif
+}
+
+// index of the lowest set bit. bb must not be 0
+static inline int Lsb(Bitboard_t bb) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bb);
+    return (int)index;
+#else
+    return __builtin_ctzll(bb);
+#endif
+}
+
+// returns the lowest set bit and clears it
+static inline int PopLsb(Bitboard_t* bb) {
+    int sq = Lsb(*bb);
+    *bb &= *bb - 1;
+    return sq;
+}
+
+/* precomputed leaper attacks, filled by InitBitboards() */
+extern Bitboard_t KnightAttacks[SQUARE_COUNT];
+extern Bitboard_t KingAttacks[SQUARE_COUNT];
+extern Bitboard_t PawnAttacks[COLOR_IDX_COUNT][SQUARE_COUNT];
+
+// squares strictly between two aligned squares / the whole line through them (0 if not aligned)
+extern Bitboard_t BetweenBB[SQUARE_COUNT][SQUARE_COUNT];
+extern Bitboard_t LineBB[SQUARE_COUNT][SQUARE_COUNT];
+
+// safe to call more than once
+void InitBitboards(void);
+
+#endif // BITBOARD_H
@@ -1,40 +1,72 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-#include <SDL2/SDL.h>
 #include <stdbool.h>
 #include "setting.h"
 #include "piece.h"
 #include "move.h"
+#include "bitboard.h"
+#include "fen.h"
+
+// castling rights, stored as a bit set in Board_t.castling
+enum {
+    CASTLE_WHITE_KING  = 1,
+    CASTLE_WHITE_QUEEN = 2,
+    CASTLE_BLACK_KING  = 4,
+    CASTLE_BLACK_QUEEN = 8
+};
+
+#define NO_SQUARE -1
+
+// everything MakeMove overwrites that can't be recomputed from the move itself
+typedef struct UndoInfo {
+    PackedMove_t move;
+    Piece_t moved;    // the piece as it stood on the from square (before promotion)
+    Piece_t captured; // type is PIECE_NONE if nothing was taken
+    int captured_square;
+    int castling;
+    int ep_square;
+    int halfmove;
+    uint64_t key;
+} UndoInfo_t;
 
 typedef struct Board {
-    Piece_t* pieces;//[DIM_X * DIM_Y];
+    Piece_t pieces[DIM_X * DIM_Y];
     char turn;
 
+    int castling;  // CASTLE_* bits
+    int ep_square; // square a pawn can capture onto en passant, or NO_SQUARE
+    int halfmove;  // plies since the last capture or pawn move
+    int fullmove;
+
+    uint64_t key;  // zobrist hash of the position, see zobrist.h
+    uint64_t pawn_key; // the same over pawns alone, indexes the pawn table (pawns.h)
+
+    // material + piece-square sums, white minus black, and the game phase. see evaluate.h
+    int psq_mg;
+    int psq_eg;
+    int phase;
+
     Piece_t* WhiteKing;
     Piece_t* BlackKing;
+
+    // set-based view of pieces[], kept in sync by MakeMove/UnmakeMove
+    Bitboard_t bitboards[COLOR_IDX_COUNT][PIECE_IDX_COUNT];
+    Bitboard_t occupancy[COLOR_IDX_COUNT];
+    Bitboard_t occupied;
     
+    // moves played through movePiece, so the GUI can take them back
     struct {
-        Piece_t** history_state; // saving piece states
-        size_t history_size;
-        size_t real_history_size;
+        UndoInfo_t states[MAX_GAME_PLY];
+        size_t size;
     } History;
 
 } Board_t;
 
 // Initialization functions
 void InitBoard(Board_t* board);
-void InitBoardFromFen(Board_t* board, const char* fen);
-
-// Texture loading
-bool loadPieceTextures(SDL_Renderer* renderer, Board_t* board);
-
-// Drawing functions
-void highlight_coord(int row, int col);
-void unhighlight_coord();
-void drawBoard(SDL_Renderer* renderer);
-void drawHighlighted(SDL_Renderer* renderer);
-void drawPieces(SDL_Renderer* renderer, Board_t* board);
+bool InitBoardFromFen(Board_t* board, const char* fen); // false: not a valid FEN, board gets the starting position
+void InitBoardFromPosition(Board_t* board, const FenPosition_t* position);
 
 // Debug / utility
 void printBoard(Board_t* board);
@@ -42,10 +74,25 @@ void printBoard(Board_t* board);
 // Board manipulation
 Piece_t* getPiece(Board_t* board, int row, int col);
 void movePiece(Board_t* board, Piece_t* piece, int nrow, int ncol);
-void getFEN(Board_t* board, char buffer[]);
 void UndoMove(Board_t* board);
 
+// full FEN with clocks, NUL terminated. returns its length, 0 if it doesn't fit in size
+size_t WriteFen(const Board_t* board, char* buffer, size_t size);
+
+// plays a legal move and records it in History so UndoMove can take it back. false if History is full
+bool PlayMove(Board_t* board, PackedMove_t move);
+
+// plays a move generated for this position without validating it.
+// undo receives what UnmakeMove needs to restore the position exactly
+void MakeMove(Board_t* board, PackedMove_t move, UndoInfo_t* undo);
+void UnmakeMove(Board_t* board, const UndoInfo_t* undo);
+
 bool IsCheck(Board_t* board, PieceColor_t color);
+bool IsSquareAttacked(const Board_t* board, int square, PieceColor_t by);
+Bitboard_t AttackersTo(const Board_t* board, int square, Bitboard_t occupied); // both colors
+
+// independent copy, e.g. one per search thread. plain assignment would share the king pointers
+void CopyBoard(Board_t* dst, const Board_t* src);
 
 // Cleanup
 void freeBoard(Board_t* board);
@@ -0,0 +1,95 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "board.h"
+#include "mapfile.h"
+
+/*
+    Polyglot opening books (.bin).
+
+    A book is a sorted array of 16 byte big endian entries: position key,
+    move, weight and a learn field that is ignored. The file is mapped
+    read-only, so every process using the same book shares one copy, and
+    is used in place.
+
+    Opening the book copies the first key of every BOOK_BLOCK_ENTRIES
+    entries into an index, 1/256 of the file. Zobrist keys are uniform,
+    so a lookup interpolates into the index, which stays in cache, and
+    then between the end keys of one block, landing within a cache line
+    or two of the entry: a single page of the book is touched.
+
+    Keys come from the 781 Random64 numbers of the Polyglot format,
+    compiled into src/book.c, so any standard book works without other
+    files.
+
+    Moves come back as PackedMove_t, found among the legal moves of the
+    position, so the search, UCI and the GUI (through UnpackMove) can play
+    them directly. A book entry that isn't legal is skipped.
+*/
+
+#define POLYGLOT_RANDOM_COUNT 781
+#define POLYGLOT_START_KEY 0x463B96181691FC9CULL // of the starting position
+
+#define BOOK_BLOCK_ENTRIES 256 // 4 KB, a page
+
+// as stored, big endian
+typedef struct BookEntry {
+    uint8_t key[8];
+    uint8_t move[2];
+    uint8_t weight[2];
+    uint8_t learn[4];
+} BookEntry_t;
+
+_Static_assert(sizeof(BookEntry_t) == 16, "Polyglot entries are 16 bytes");
+
+typedef struct BookMove {
+    PackedMove_t move;
+    uint16_t weight;
+} BookMove_t;
+
+typedef struct Book {
+    MappedFile_t file;
+    const BookEntry_t* entries;
+    size_t count;
+    uint64_t* index;  // key of entries[b * BOOK_BLOCK_ENTRIES]
+    size_t blocks;
+} Book_t;
+
+uint64_t PolyglotKey(const Board_t* board);
+
+// Polyglot's move encoding, castling as king takes rook
+uint16_t PolyglotMove(PackedMove_t move);
+
+bool BookOpen(const char* path, Book_t* book);
+void BookClose(Book_t* book);
+
+// index of the first entry for key, book->count if there is none
+size_t BookFind(const Book_t* book, uint64_t key);
+
+// the book's legal moves for the position, at most max. returns how many were found
+int BookProbe(const Book_t* book, Board_t* board, BookMove_t* moves, int max);
+
+// a book move picked with probability proportional to its weight. random is any
+// uniformly distributed number. NO_MOVE if the position isn't in the book
+PackedMove_t BookPick(const Book_t* book, Board_t* board, uint64_t random);
+
+// big endian field access, for tools that build books
+static inline uint64_t BookEntryKey(const BookEntry_t* entry) {
+    uint64_t key;
+    memcpy(&key, entry->key, sizeof(key));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    key = __builtin_bswap64(key);
+#endif
+    return key;
+}
+
+static inline uint16_t BookEntryMove(const BookEntry_t* entry)   { return (uint16_t)(entry->move[0] << 8 | entry->move[1]); }
+static inline uint16_t BookEntryWeight(const BookEntry_t* entry) { return (uint16_t)(entry->weight[0] << 8 | entry->weight[1]); }
+
+void BookEncodeEntry(BookEntry_t* entry, uint64_t key, uint16_t move, uint16_t weight);
+
+#endif // BOOK_H
@@ -0,0 +1,67 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "board.h"
+#include "search.h"
+
+/*
+    Runs searches on a worker thread so the SDL loop never waits for one.
+
+    Jobs go through a lock-free single producer / single consumer ring,
+    so only the thread that called EngineStart (the SDL loop) may call
+    the functions below. Every job gets an id, returned when it is
+    queued, and everything the engine sends back carries it so stale
+    results can be told apart.
+
+    Results come back as SDL user events: EngineInfoEvent after every
+    finished iteration with an EngineInfo_t in user.data1, and
+    EngineResultEvent when a search ends with an EngineResult_t. Pass
+    both to EngineReleaseEvent once handled.
+
+    Stop and ponderhit don't wait in the ring: the worker is busy inside
+    the search when they matter, so they go straight to it and also
+    cover jobs that are queued but not started yet.
+*/
+
+#define ENGINE_QUEUE_SIZE 8 // power of two
+
+typedef struct EngineInfo {
+    uint32_t job;
+    SearchInfo_t info;
+} EngineInfo_t;
+
+typedef struct EngineResult {
+    uint32_t job;
+    bool ponder;  // the job was queued by EnginePonder
+    uint64_t key; // of the position searched
+    SearchResult_t result;
+} EngineResult_t;
+
+extern Uint32 EngineInfoEvent;
+extern Uint32 EngineResultEvent;
+
+// starts the worker and registers the event types
+bool EngineStart(void);
+
+// stops the current search, drops queued jobs and joins the worker
+void EngineShutdown(void);
+
+// 0 if the queue is full
+uint32_t EngineSearch(const Board_t* board, int64_t movetime);
+
+// searches board (the position after the expected reply) without a clock
+// until EnginePonderHit, which turns it into a movetime search, or EngineStop
+uint32_t EnginePonder(const Board_t* board, int64_t movetime);
+
+// the expected reply was played
+void EnginePonderHit(void);
+
+// ends the running search, which still sends its result, and drops every job queued so far
+void EngineStop(void);
+
+void EngineReleaseEvent(const SDL_Event* event);
+
+#endif // ENGINE_H
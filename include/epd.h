@@ -0,0 +1,25 @@
+#ifndef EPD_H
+#define EPD_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "fen.h"
+
+/*
+    Bulk loading of EPD (or FEN per line) files, for dataset jobs. The
+    file is mapped and cut into one chunk per thread at line boundaries.
+    Each thread counts its lines, then parses them straight into its
+    slice of one shared array, so nothing is copied or allocated per
+    line. EPD operations after the fields are skipped.
+*/
+
+typedef struct EpdSet {
+    FenPosition_t* positions; // in file order
+    size_t count;
+    size_t rejected; // lines that aren't a valid position. blank lines and # comments don't count
+} EpdSet_t;
+
+bool LoadEpdFile(const char* path, int threads, EpdSet_t* set);
+void FreeEpdSet(EpdSet_t* set);
+
+#endif // EPD_H
@@ -0,0 +1,39 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "board.h"
+#include "pawns.h"
+
+// centipawns, used for exchanges and move ordering
+#define PAWN_VALUE   100
+#define KNIGHT_VALUE 320
+#define BISHOP_VALUE 330
+#define ROOK_VALUE   500
+#define QUEEN_VALUE  900
+
+extern const int PieceValues[PIECE_IDX_COUNT];
+
+/*
+    Material and piece-square values for the middlegame and the endgame,
+    already signed (black negative) and mirrored for black, so Board_t can
+    add or subtract one entry whenever a piece enters or leaves a square.
+    The score is blended between the two by the phase: the sum of
+    PhaseWeights of the pieces on the board, PHASE_MAX with all of them.
+*/
+#define PHASE_MAX 24
+
+extern int PsqMg[COLOR_IDX_COUNT][PIECE_IDX_COUNT][SQUARE_COUNT];
+extern int PsqEg[COLOR_IDX_COUNT][PIECE_IDX_COUNT][SQUARE_COUNT];
+extern const int PhaseWeights[PIECE_IDX_COUNT];
+
+// safe to call more than once
+void InitEvaluation(void);
+
+// from scratch, used on FEN load and to check the incremental sums
+void ComputePsq(const Board_t* board, int* mg, int* eg, int* phase);
+
+// static score in centipawns from the side to move's point of view.
+// pawns caches the pawn structure terms, NULL computes them every call
+int Evaluate(const Board_t* board, PawnTable_t* pawns);
+
+#endif // EVALUATE_H
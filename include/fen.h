@@ -0,0 +1,59 @@
+#ifndef FEN_H
+#define FEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bitboard.h"
+
+/*
+    FEN and EPD text. The parser never allocates, never logs and never
+    reads past the length it is given, so it can run straight on a
+    mapped file with one thread per chunk. It fills a FenPosition_t, a
+    flat copy of the fields. InitBoardFromPosition (board.h) turns that
+    into a Board_t, and WriteFen (board.h) writes one back.
+
+    Accepted: the four placement/side/castling/en passant fields, then
+    optionally the halfmove and fullmove clocks. Whatever follows, such as
+    EPD operations, is left for the caller. Castling rights whose king or
+    rook isn't on its home square are dropped rather than rejected,
+    because plenty of real files carry them. A position where the side
+    not to move is in check is refused: the first move would take a king.
+*/
+
+#define FEN_MAX_LENGTH 100 // longest FEN WriteFen can produce, terminator included
+
+#define FEN_EMPTY 0
+#define FEN_PIECE(color_index, piece_index) (1 + (color_index) * PIECE_IDX_COUNT + (piece_index))
+
+typedef struct FenPosition {
+    uint8_t squares[SQUARE_COUNT]; // FEN_EMPTY or FEN_PIECE
+    char turn;                     // WHITE or BLACK
+    uint8_t castling;              // CASTLE_* bits
+    int8_t ep_square;              // NO_SQUARE if none
+    uint16_t halfmove;
+    uint16_t fullmove;
+} FenPosition_t;
+
+typedef enum FenError {
+    FEN_OK,
+    FEN_ERROR_PLACEMENT,  // bad letter, row not 8 squares wide, not 8 rows, pawn on a back rank
+    FEN_ERROR_KINGS,      // not exactly one king per side
+    FEN_ERROR_SIDE,
+    FEN_ERROR_CHECK,      // the side not to move is in check, kings next to each other included
+    FEN_ERROR_CASTLING,
+    FEN_ERROR_EN_PASSANT, // not on the rank behind a pawn that just moved two squares
+    FEN_ERROR_CLOCK
+} FenError_t;
+
+// text needs no terminator. consumed (may be NULL) gets the offset just past the last field read
+FenError_t ParseFen(const char* text, size_t length, FenPosition_t* position, size_t* consumed);
+
+// the rules a position has to keep beyond the FEN syntax: pawns off the back ranks, one king a side, the
+// side not to move not in check, castling rights with king and rook at home, an en passant square behind
+// the pawn that just moved two squares and a fullmove number from 1. ParseFen applies them, and so does
+// every other way into a FenPosition_t, such as packed records (packed.h)
+FenError_t ValidatePosition(const FenPosition_t* position);
+
+const char* FenErrorString(FenError_t error);
+
+#endif // FEN_H
@@ -0,0 +1,38 @@
+#ifndef GUI_H
+#define GUI_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include "board.h"
+
+/*
+    Everything that needs SDL lives behind this header.
+    The rules code (board, move, ...) never sees a renderer or a texture.
+*/
+
+// per window selection state, owned by the caller instead of living in globals
+typedef struct GuiState {
+    bool is_highlighted;
+    SDL_Rect highlight_area;
+    MoveList_t legal_moves; // targets of the selected piece
+} GuiState_t;
+
+void InitGuiState(GuiState_t* state);
+
+// Texture loading, one texture per piece type and color
+bool loadPieceTextures(SDL_Renderer* renderer);
+void freePieceTextures(void);
+
+// Drawing functions
+void highlight_coord(GuiState_t* state, int row, int col);
+void unhighlight_coord(GuiState_t* state);
+void drawBoard(SDL_Renderer* renderer);
+void drawHighlighted(SDL_Renderer* renderer, const GuiState_t* state);
+void drawPieces(SDL_Renderer* renderer, Board_t* board);
+
+/* for highlighting */
+void set_legal_moves(GuiState_t* state, const MoveList_t* movelist);
+void clear_legal_moves(GuiState_t* state);
+void draw_legal_moves(SDL_Renderer* renderer, const GuiState_t* state);
+
+#endif // GUI_H
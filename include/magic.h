@@ -0,0 +1,57 @@
+#ifndef MAGIC_H
+#define MAGIC_H
+
+#include "bitboard.h"
+
+/*
+    Sliding piece attacks through precomputed lookup tables.
+    Each square stores the mask of squares that can block it (edges excluded)
+    and a slice of the attack table. The slice is indexed either by the
+    classic magic multiplication or, on CPUs with BMI2, by PEXT.
+    Which one is used is decided once in InitMagics().
+*/
+
+typedef struct Magic {
+    Bitboard_t mask;
+    Bitboard_t magic;
+    Bitboard_t* attacks;
+    unsigned shift;
+} Magic_t;
+
+extern Magic_t RookMagics[SQUARE_COUNT];
+extern Magic_t BishopMagics[SQUARE_COUNT];
+extern bool UsePext;
+
+// safe to call more than once; InitBitboards() calls it
+void InitMagics(void);
+
+// slow ray walk, used to fill the tables and as a reference
+Bitboard_t SlidingAttacks(int sq, Bitboard_t occupied, bool diagonal);
+
+static inline unsigned MagicIndex(const Magic_t* m, Bitboard_t occupied) {
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    if(UsePext) {
+        // inline asm so this file doesn't need to be compiled with -mbmi2
+        Bitboard_t index;
+        __asm__("pextq %2, %1, %0" : "=r"(index) : "r"(occupied), "r"(m->mask));
+        return (unsigned)index;
+    }
+#endif
+    return (unsigned)(((occupied & m->mask) * m->magic) >> m->shift);
+}
+
+static inline Bitboard_t RookAttacks(int sq, Bitboard_t occupied) {
+    const Magic_t* m = &RookMagics[sq];
+    return m->attacks[MagicIndex(m, occupied)];
+}
+
+static inline Bitboard_t BishopAttacks(int sq, Bitboard_t occupied) {
+    const Magic_t* m = &BishopMagics[sq];
+    return m->attacks[MagicIndex(m, occupied)];
+}
+
+static inline Bitboard_t QueenAttacks(int sq, Bitboard_t occupied) {
+    return RookAttacks(sq, occupied) | BishopAttacks(sq, occupied);
+}
+
+#endif // MAGIC_H
@@ -0,0 +1,23 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+    A whole file, read only. Mapped where the platform allows it, so
+    every process opening the same file shares one physical copy and
+    multi-gigabyte files cost no heap. Elsewhere it is read into memory.
+*/
+typedef struct MappedFile {
+    const uint8_t* data;
+    size_t size;
+    bool mapped; // false: data is a heap copy
+} MappedFile_t;
+
+// sequential: the file will be read front to back once, so the kernel can read ahead aggressively
+bool MapFile(const char* path, MappedFile_t* file, bool sequential);
+void UnmapFile(MappedFile_t* file);
+
+#endif // MAPFILE_H
@@ -3,11 +3,14 @@
 #include "piece.h"
 #include "setting.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 
 // circular includes are so annoying
 typedef struct Board Board_t;
 typedef struct Piece Piece_t;
 
+// a move as the GUI sees it: two squares picked with the mouse
 typedef struct Move {
     int from_row, from_col;
     int to_row, to_col;
@@ -15,9 +18,52 @@ typedef struct Move {
     bool promotion;
 } Move_t;
 
-// hate carrying around a Move_t & size ptr
+/*
+    Packed move used everywhere else (move lists, history, search tables)
+    bits 0-5   from square (row * DIM_X + col)
+    bits 6-11  to square
+    bits 12-15 flags, see MoveFlag below
+    0 (a8 to a8) is never a real move and means "no move".
+*/
+typedef uint16_t PackedMove_t;
+
+#define NO_MOVE ((PackedMove_t)0)
+
+enum MoveFlag {
+    FLAG_QUIET        = 0,
+    FLAG_DOUBLE_PUSH  = 1,
+    FLAG_KING_CASTLE  = 2,
+    FLAG_QUEEN_CASTLE = 3,
+    FLAG_CAPTURE      = 4,
+    FLAG_EN_PASSANT   = 5,
+    FLAG_PROMOTION    = 8,  // low two bits pick the piece: knight, bishop, rook, queen
+    FLAG_PROMO_KNIGHT = 8,
+    FLAG_PROMO_BISHOP = 9,
+    FLAG_PROMO_ROOK   = 10,
+    FLAG_PROMO_QUEEN  = 11
+    // 12-15: promotion with capture (FLAG_PROMO_* | FLAG_CAPTURE)
+};
+
+static inline PackedMove_t PackMove(int from, int to, int flags) {
+    return (PackedMove_t)(from | (to << 6) | (flags << 12));
+}
+
+static inline int MoveFrom(PackedMove_t move)  { return move & 63; }
+static inline int MoveTo(PackedMove_t move)    { return (move >> 6) & 63; }
+static inline int MoveFlags(PackedMove_t move) { return move >> 12; }
+
+static inline bool IsCapture(PackedMove_t move)   { return (MoveFlags(move) & FLAG_CAPTURE) != 0; }
+static inline bool IsPromotion(PackedMove_t move) { return (MoveFlags(move) & FLAG_PROMOTION) != 0; }
+
+static inline PieceType_t PromotionPiece(PackedMove_t move) {
+    static const PieceType_t pieces[4] = { KNIGHT, BISHOP, ROOK, QUEEN };
+    return pieces[MoveFlags(move) & 3];
+}
+
+// fixed capacity so generators can append in place with no allocation.
+// lives on the stack: declare it and set size = 0 before generating
 typedef struct MoveList {
-    Move_t* moves;
+    PackedMove_t moves[MAX_MOVES];
     size_t size;
 
 } MoveList_t;
@@ -25,25 +71,39 @@ typedef struct MoveList {
 void InitMoveP(Move_t* move, Piece_t* piece, int to_row, int to_col, bool promotion);
 void InitMove(Move_t* move, int from_row, int from_col, int to_row, int to_col, bool promotion);
 
-void AddMove(MoveList_t* movelist, Move_t* moves, size_t* size);
-void AddMoveM(MoveList_t* movelist, MoveList_t movelist2);
+/* conversion at the GUI boundary */
+void UnpackMove(PackedMove_t packed, Move_t* move);
+PackedMove_t MatchMove(Board_t* board, const Move_t* move); // NO_MOVE if it isn't legal, promotes to a queen
+
+void MoveToString(PackedMove_t move, char buffer[6]);
+PackedMove_t StringToMove(Board_t* board, const char* text); // e2e4, e7e8q. NO_MOVE unless it's legal here
+PackedMove_t SanToMove(Board_t* board, const char* text, size_t length); // Nf3, exd5, O-O. NO_MOVE unless legal and unambiguous
+
+void AddMoveM(MoveList_t* movelist, const MoveList_t* movelist2);
 
-/* move generation */
-MoveList_t getLegalMoves(Board_t* board, Piece_t* piece);
+// the legal moves split in two parts that together make up GenerateMoves
+typedef enum GenType {
+    GEN_ALL,
+    GEN_NOISY, // captures, en passant and every promotion
+    GEN_QUIET  // everything else, castling included
+} GenType_t;
 
-MoveList_t KingMoves(Board_t* board, Piece_t* piece);
-MoveList_t QueenMoves(Board_t* board, Piece_t* piece);
-MoveList_t BishopMoves(Board_t* board, Piece_t* piece);
-MoveList_t RookMoves(Board_t* board, Piece_t* piece);
-MoveList_t KnightMoves(Board_t* board, Piece_t* piece);
-MoveList_t PawnMoves(Board_t* board, Piece_t* piece);
+/* move generation, every generator appends to movelist */
+void getLegalMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist);
+void GenerateMoves(Board_t* board, MoveList_t* movelist); // every piece of the side to move
+void GenerateNoisy(Board_t* board, MoveList_t* movelist);
+void GenerateQuiets(Board_t* board, MoveList_t* movelist);
+
+void KingMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist);
+void QueenMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist);
+void BishopMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist);
+void RookMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist);
+void KnightMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist);
+void PawnMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist);
 
 /* move validation */
 bool isValidMove(Board_t* board, Piece_t* piece, Move_t* move);
-
-/* for highlighting */
-void set_legal_moves(MoveList_t movelist);
-void draw_legal_moves(SDL_Renderer* renderer);
+bool IsLegalMove(Board_t* board, PackedMove_t move);
 
 #endif // MOVE_H
 
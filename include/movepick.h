@@ -0,0 +1,78 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include "board.h"
+
+/*
+    Hands out the moves of a position one at a time in the order the
+    search wants to try them:
+
+    1. the hash move
+    2. captures and promotions, most valuable victim / least valuable attacker,
+       except captures that lose material by static exchange (see.h)
+    3. the two killer moves of this ply
+    4. the remaining quiet moves by history score
+    5. the losing captures put aside in stage 2
+
+    A stage is only generated when the one before it is used up, so a
+    cutoff on the hash move or a capture never pays for the quiet moves.
+    Moves that don't come from the generator (hash move, killers) are
+    checked for legality before they are returned.
+*/
+
+// history scores stay within +-HISTORY_MAX
+#define HISTORY_MAX 16384
+
+typedef int History_t[SQUARE_COUNT][SQUARE_COUNT]; // [from][to] for one side
+
+typedef enum PickStage {
+    STAGE_HASH,
+    STAGE_NOISY_INIT,
+    STAGE_NOISY,
+    STAGE_KILLER_1,
+    STAGE_KILLER_2,
+    STAGE_QUIET_INIT,
+    STAGE_QUIET,
+    STAGE_BAD_NOISY,
+    STAGE_DONE
+} PickStage_t;
+
+typedef struct MovePicker {
+    Board_t* board;
+    PickStage_t stage;
+
+    PackedMove_t hash_move;
+    PackedMove_t killers[2];
+    const History_t* history; // of the side to move, may be NULL
+    bool noisy_only;          // quiescence: stop after stage 2, keep losing captures in order
+
+    MoveList_t list; // the stage being handed out
+    int scores[MAX_MOVES];
+    size_t index;
+
+    MoveList_t bad_noisy;
+    size_t bad_index;
+} MovePicker_t;
+
+// killers and history may be NULL
+void InitMovePicker(MovePicker_t* picker, Board_t* board, PackedMove_t hash_move,
+                    const PackedMove_t killers[2], const History_t* history);
+
+// hash move (if noisy) and noisy moves only, the caller decides what to prune
+void InitQuiescencePicker(MovePicker_t* picker, Board_t* board, PackedMove_t hash_move);
+
+// NO_MOVE once every legal move was returned
+PackedMove_t NextMove(MovePicker_t* picker);
+
+// rewards a quiet move that caused a cutoff (bonus > 0) or punishes one that didn't
+static inline void UpdateHistory(History_t* history, PackedMove_t move, int bonus) {
+    int* entry = &(*history)[MoveFrom(move)][MoveTo(move)];
+
+    if(bonus > HISTORY_MAX) bonus = HISTORY_MAX;
+    if(bonus < -HISTORY_MAX) bonus = -HISTORY_MAX;
+
+    // pulls towards the limit more slowly the closer it is, so scores can't overflow
+    *entry += bonus - *entry * (bonus < 0 ? -bonus : bonus) / HISTORY_MAX;
+}
+
+#endif // MOVEPICK_H
@@ -0,0 +1,82 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "board.h"
+
+/*
+    Efficiently updatable neural network evaluation.
+
+    768 inputs (own/enemy x 6 piece types x 64 squares, seen from one
+    side) feed NNUE_HIDDEN int16 neurons, once from white's view and once
+    from black's. Those two halves, the accumulator, only change by a few
+    weight rows when a move is made, so they're updated from the parent's
+    accumulator instead of being recomputed. The output layer clamps both
+    halves to [0, NNUE_QA] (side to move first) and takes a dot product
+    with int8 weights.
+
+    The kernels come in AVX2, SSE4.1 and scalar versions, picked once at
+    load time from what the CPU supports.
+
+    Weights are mapped read-only from the file, so processes that load
+    the same file share one physical copy.
+
+    File layout, little endian, every section 64 byte aligned:
+        NnueHeader_t
+        int16 feature_bias[NNUE_HIDDEN]
+        int16 feature_weights[NNUE_INPUTS][NNUE_HIDDEN]
+        int8  output_weights[2][NNUE_HIDDEN] (side to move, then the other side)
+*/
+
+#define NNUE_INPUTS 768
+#define NNUE_HIDDEN 256
+#define NNUE_QA 127 // activation clamp, one unit of the accumulator
+#define NNUE_QB 64  // output weight scale
+
+#define NNUE_MAGIC "CHSNNUE1"
+#define NNUE_VERSION 1
+
+typedef struct NnueHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t inputs;
+    uint32_t hidden;
+    int32_t output_bias;
+    int32_t scale; // centipawns = output * scale / (NNUE_QA * NNUE_QB)
+    uint8_t reserved[36];
+} NnueHeader_t;
+
+typedef struct Accumulator {
+    _Alignas(64) int16_t values[COLOR_IDX_COUNT][NNUE_HIDDEN]; // [perspective]
+} Accumulator_t;
+
+typedef enum NnueKernel {
+    NNUE_KERNEL_SCALAR,
+    NNUE_KERNEL_SSE41,
+    NNUE_KERNEL_AVX2,
+    NNUE_KERNEL_COUNT
+} NnueKernel_t;
+
+// maps the network and picks the best kernel. keeps the old network on failure
+bool NnueLoad(const char* path);
+void NnueUnload(void);
+bool NnueLoaded(void);
+
+// for benchmarks: false if the CPU can't run it
+bool NnueSelectKernel(NnueKernel_t kernel);
+NnueKernel_t NnueCurrentKernel(void);
+const char* NnueKernelName(NnueKernel_t kernel);
+
+/* the rest is only valid while a network is loaded */
+
+// from scratch: bias plus one row per piece
+void NnueRefresh(Accumulator_t* acc, const Board_t* board);
+
+// acc = prev with the move recorded in undo applied. acc and prev may not alias
+void NnueUpdate(Accumulator_t* acc, const Accumulator_t* prev, const UndoInfo_t* undo);
+
+// centipawns from the point of view of side
+int NnueEvaluate(const Accumulator_t* acc, PieceColor_t side);
+
+#endif // NNUE_H
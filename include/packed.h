@@ -0,0 +1,88 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "board.h"
+#include "mapfile.h"
+
+/*
+    Fixed size binary positions for datasets, 32 bytes each against
+    about 60 for a FEN, and no text to parse on the way back in.
+
+    occupancy has a bit for every square holding a piece, with the
+    numbering of Board_t (bit 0 is a8). pieces then gives one nibble
+    per set bit, in increasing square order and low nibble first: the
+    FEN_PIECE code of the piece (fen.h), so 0 never appears. A legal
+    position has at most 32 pieces, which fill all 16 bytes.
+
+    Conversions never allocate. Unpacking checks the record, since it
+    may come from a damaged or foreign file.
+
+    File layout, little endian:
+        PackedHeader_t
+        PackedPosition_t records[] (the count follows from the file size)
+    Record n sits at a fixed offset, so it is read in O(1) without
+    touching the ones before it.
+*/
+
+#define PACKED_MAGIC "CHSPACK1"
+#define PACKED_VERSION 1
+
+#define PACKED_BLACK_TO_MOVE 1    // flags bit 0
+#define PACKED_CASTLING_SHIFT 1   // flags bits 1-4: CASTLE_* bits
+#define PACKED_NO_EP 0xFF
+
+typedef struct PackedPosition {
+    uint64_t occupancy;
+    uint8_t pieces[16];
+    uint8_t flags;
+    uint8_t ep_square; // PACKED_NO_EP if none
+    uint16_t halfmove;
+    uint16_t fullmove;
+    uint16_t extra;    // free for the dataset, e.g. a score or the game result. 0 when packed
+} PackedPosition_t;
+
+typedef struct PackedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+} PackedHeader_t;
+
+_Static_assert(sizeof(PackedPosition_t) == 32, "records are 32 bytes");
+_Static_assert(sizeof(PackedHeader_t) == 16, "records start 16 bytes in");
+
+// false if the position has more than 32 pieces or breaks a rule of ValidatePosition (fen.h)
+bool PackPosition(const FenPosition_t* position, PackedPosition_t* packed);
+bool UnpackPosition(const PackedPosition_t* packed, FenPosition_t* position); // false: not a valid record
+
+bool PackBoard(const Board_t* board, PackedPosition_t* packed);
+bool UnpackBoard(const PackedPosition_t* packed, Board_t* board);           // false: not a valid record, board untouched
+
+/* reading: the file is mapped, records are used in place */
+typedef struct PackedFile {
+    MappedFile_t file;
+    const PackedPosition_t* records;
+    size_t count;
+} PackedFile_t;
+
+bool OpenPackedFile(const char* path, PackedFile_t* file);
+void ClosePackedFile(PackedFile_t* file);
+
+static inline const PackedPosition_t* PackedRecord(const PackedFile_t* file, size_t n) {
+    return (n < file->count) ? &file->records[n] : NULL;
+}
+
+/* writing: records are appended to a new file */
+typedef struct PackedWriter {
+    FILE* file;
+    size_t count;
+} PackedWriter_t;
+
+bool CreatePackedFile(const char* path, PackedWriter_t* writer);
+bool WritePacked(PackedWriter_t* writer, const PackedPosition_t* records, size_t count);
+bool ClosePackedWriter(PackedWriter_t* writer); // false if anything failed to reach the disk
+
+#endif // PACKED_H
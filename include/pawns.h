@@ -0,0 +1,49 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "board.h"
+
+/*
+    Pawn structure terms: passed, isolated, doubled and backward pawns,
+    and the pawn shield in front of a king on each file. They only
+    depend on where the pawns are, which rarely changes between
+    neighbouring nodes, so each search thread caches them in its own
+    table keyed by Board_t.pawn_key and only recomputes them after a pawn
+    moves, is captured or promotes.
+*/
+
+typedef struct PawnEntry {
+    uint64_t key;
+    int16_t mg, eg; // white minus black, shields not included
+    int8_t shield[COLOR_IDX_COUNT][DIM_X]; // midgame bonus for that color's king on each file
+    bool used;
+    Bitboard_t passed; // both colors
+} PawnEntry_t;
+
+#define PAWN_TABLE_ENTRIES 8192 // power of two
+
+typedef struct PawnTable {
+    PawnEntry_t entries[PAWN_TABLE_ENTRIES];
+
+    // owned by one thread, atomic only so a reporting thread can read them
+    _Atomic uint64_t probes;
+    _Atomic uint64_t hits;
+} PawnTable_t;
+
+// safe to call more than once
+void InitPawns(void);
+
+void ClearPawnTable(PawnTable_t* table);
+
+// counters only, the cached entries stay valid from one search to the next
+void ResetPawnStats(PawnTable_t* table);
+
+// from scratch, without the table
+void ComputePawns(const Board_t* board, PawnEntry_t* entry);
+
+// the entry for the board's pawns, computed on a miss
+const PawnEntry_t* ProbePawns(PawnTable_t* table, const Board_t* board);
+
+#endif // PAWNS_H
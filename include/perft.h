@@ -0,0 +1,10 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <stdint.h>
+#include "board.h"
+
+// counts leaf nodes of the legal move tree, depth plies deep
+uint64_t Perft(Board_t* board, int depth);
+
+#endif // PERFT_H
@@ -0,0 +1,93 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "board.h"
+
+/*
+    PGN game databases, read in place. Tag names and values, the
+    movetext and each SAN token are spans into the caller's text (for
+    PgnScanFile, the mapped file), so nothing is copied or allocated
+    per game.
+
+    A game is its tag pairs followed by movetext, which runs until the
+    next line that starts with '['. Comments ({...} and ;...), recursive
+    variations, NAGs and move numbers are skipped. Replay follows the
+    main line only and stops at the result.
+*/
+
+#define PGN_MAX_TAGS 32 // further tags are skipped
+
+typedef struct PgnSpan {
+    const char* text; // not NUL terminated
+    size_t length;
+} PgnSpan_t;
+
+typedef struct PgnTag {
+    PgnSpan_t name;
+    PgnSpan_t value; // without the quotes, escapes left as they are
+} PgnTag_t;
+
+typedef struct PgnGame {
+    PgnTag_t tags[PGN_MAX_TAGS];
+    int tag_count;
+    PgnSpan_t movetext;
+    size_t offset; // of the game's first byte from the start of the text
+} PgnGame_t;
+
+typedef struct PgnReader {
+    const char* start;
+    const char* cursor;
+    const char* end;
+} PgnReader_t;
+
+typedef enum PgnError {
+    PGN_OK,
+    PGN_ERROR_FEN,    // the FEN tag isn't a valid position
+    PGN_ERROR_MOVE,   // a SAN token that isn't a legal, unambiguous move
+    PGN_ERROR_LENGTH, // more than MAX_GAME_PLY plies
+    PGN_ERROR_COUNT
+} PgnError_t;
+
+// the main line as played, so it can be walked back with UnmakeMove
+typedef struct PgnReplay {
+    UndoInfo_t undo[MAX_GAME_PLY];
+    int plies;
+    PgnSpan_t bad_move; // the token that failed on PGN_ERROR_MOVE
+} PgnReplay_t;
+
+typedef struct PgnStats {
+    uint64_t games;
+    uint64_t plies;                     // replayed over all games
+    uint64_t failed[PGN_ERROR_COUNT];   // games stopped by each error, failed[PGN_OK] stays 0
+    uint64_t bytes;
+} PgnStats_t;
+
+void PgnInitReader(PgnReader_t* reader, const char* text, size_t length);
+
+// false once only whitespace is left
+bool PgnNextGame(PgnReader_t* reader, PgnGame_t* game);
+
+// NULL if the game has no such tag
+const PgnSpan_t* PgnFindTag(const PgnGame_t* game, const char* name);
+
+// next main line SAN token at *cursor. false at the result or the end of the movetext
+bool PgnNextMove(const char** cursor, const char* end, PgnSpan_t* san);
+
+// sets board up from the FEN tag, or the starting position, and plays the main line with MakeMove.
+// on an error, board and replay hold the game up to the ply that failed
+PgnError_t PgnReplayGame(const PgnGame_t* game, Board_t* board, PgnReplay_t* replay);
+
+const char* PgnErrorString(PgnError_t error);
+
+// runs on the loading threads, one game at a time per thread. thread is 0 .. threads - 1
+typedef void (*PgnGameCallback_t)(const PgnGame_t* game, const Board_t* board, const PgnReplay_t* replay,
+                                  PgnError_t error, int thread, void* data);
+
+// maps the file, splits it into one chunk of whole games per thread and replays every game.
+// on_game may be NULL. false if the file can't be read
+bool PgnScanFile(const char* path, int threads, PgnGameCallback_t on_game, void* data, PgnStats_t* stats);
+
+#endif // PGN_H
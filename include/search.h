@@ -0,0 +1,75 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "board.h"
+
+#define MAX_PLY 64
+#define MAX_SEARCH_THREADS 256
+
+#define SCORE_INFINITE 32001
+#define SCORE_MATE     32000
+#define MAX_MATE_PLIES (MAX_PLY + 256) // a mate found at any ply, or read from a tablebase (TB_MAX_PLIES) below it
+#define SCORE_MATE_IN_MAX (SCORE_MATE - MAX_MATE_PLIES) // anything above is a forced mate
+
+// handed to the report callback after every completed iteration
+typedef struct SearchInfo {
+    int depth;
+    int score;          // centipawns from the side to move, or +-(SCORE_MATE - plies)
+    uint64_t nodes;
+    int64_t time_ms;
+    uint64_t nps;
+    int hashfull;       // transposition table use per thousand
+    int pawn_hits;      // pawn table hits per thousand probes, all threads
+    PackedMove_t pv[MAX_PLY];
+    int pv_length;
+} SearchInfo_t;
+
+typedef struct SearchLimits {
+    int depth;          // 0: as deep as MAX_PLY allows
+    int64_t movetime;   // milliseconds, 0: no limit
+    uint64_t nodes;     // 0: no limit
+    bool infinite;      // ignore movetime and nodes, run until StopSearch()
+
+    // may be NULL. owned by the caller, so setting them before the search has started isn't lost
+    atomic_bool* stop;   // set to end the search, like StopSearch()
+    atomic_bool* ponder; // while true the search runs as if infinite. clearing it (ponderhit) starts the movetime clock
+
+    // may be NULL
+    void (*report)(const SearchInfo_t* info, void* data);
+    void* report_data;
+} SearchLimits_t;
+
+typedef struct SearchResult {
+    PackedMove_t best_move;   // NO_MOVE only if the position is mate or stalemate
+    PackedMove_t ponder_move; // expected reply, NO_MOVE if unknown
+    int score;
+    int depth;
+    uint64_t nodes;
+    uint64_t pawn_probes;
+    uint64_t pawn_hits;
+} SearchResult_t;
+
+/*
+    Iterative deepening principal variation search on the side to move.
+    Every search thread works on its own copy of the board, so the
+    caller's board is only read.
+*/
+SearchResult_t SearchPosition(Board_t* board, const SearchLimits_t* limits);
+
+/*
+    Lazy SMP: every thread runs the whole iterative deepening loop on the
+    same position and they only share the transposition table. Threads
+    are kept between searches. Must not be called while a search runs.
+    The first SearchPosition sets up a single thread if this wasn't called.
+*/
+bool SetSearchThreads(int count);
+int GetSearchThreads(void);
+void FreeSearchThreads(void);
+
+// safe to call from another thread; the running search returns its last full iteration
+void StopSearch(void);
+
+#endif // SEARCH_H
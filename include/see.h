@@ -0,0 +1,15 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "board.h"
+
+/*
+    Static exchange evaluation: plays out every capture on the target
+    square of move, cheapest attacker first, with either side free to
+    stop, and compares the material balance with threshold. Sliders
+    behind a piece that just captured join in as x-rays.
+    Pins are ignored. Castling, en passant and promotions count as 0.
+*/
+bool SeeGE(const Board_t* board, PackedMove_t move, int threshold);
+
+#endif // SEE_H
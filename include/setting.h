@@ -1,6 +1,8 @@
 #ifndef SETTING_H
 #define SETTING_H
 
+#include <stdio.h>
+
 #define ImagesPath "Assets/Images/"
 
 #define Width 800
@@ -29,9 +31,16 @@
 #define MAX_MOVES_QUEEN  27
 #define MAX_MOVES_KING   8
 
+// capacity of a MoveList_t. the most moves any known position has is 218
+#define MAX_MOVES 256
+
+// moves the GUI can take back. a game this long would break the 50 move rule many times over
+#define MAX_GAME_PLY 1024
+
 
-#define LOG(msg, ...) SDL_Log(msg, ##__VA_ARGS__)
-#define ERROR(msg, ...) SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, msg, ##__VA_ARGS__)
-#define WARN(msg, ...) SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, msg, ##__VA_ARGS__)
+// plain stderr so the rules code links without SDL (the GUI logs through SDL_Log itself)
+#define LOG(msg, ...) fprintf(stderr, msg "\n", ##__VA_ARGS__)
+#define ERROR(msg, ...) fprintf(stderr, "ERROR: " msg "\n", ##__VA_ARGS__)
+#define WARN(msg, ...) fprintf(stderr, "WARN: " msg "\n", ##__VA_ARGS__)
 
 #endif // SETTING_H
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "board.h"
+#include "bitboard.h"
+
+/*
+    Endgame tablebases for a king and one or two pieces against a lone
+    king (KQK, KRK, KPK, KBNK, KRBK, KPPK ...): the distance to mate with
+    perfect play from every position, computed once by retrograde
+    analysis (TbGenerate) and then probed in O(1).
+
+    Tables are stored with the strong side as white, and a position
+    where black is the strong side is probed with the colors swapped.
+    Only one of each set of mirrored positions is kept: the strong king
+    is moved into the a8-d8-d5 triangle, or onto files a-d when there
+    are pawns, which makes tables 8 (with pawns 2) times smaller.
+
+    File layout, little endian:
+        TbHeader_t
+        uint8_t values[entries], indexed by TbIndex
+    A value is TB_VALUE_DRAW, TB_VALUE_ILLEGAL for an index that isn't
+    a legal position (or is the mirror image of another), or else the
+    plies to mate + 1: odd plies win for the side to move, even plies
+    lose. Files are mapped read-only, so every process probing them
+    shares one copy.
+
+    The defending side is always a bare king. Material with a piece on
+    both sides (KRKP, KQKR, KPKP, KRKB ...) is left out on purpose: the
+    generator only has king moves and king captures for the weak side,
+    and its captures and promotions only lead into other one-sided
+    tables. Covering those would need the weak piece in the index, its
+    moves in the generator and exits into color-swapped tables. TbProbe
+    returns false for such positions and the search goes on as usual.
+
+    Castling rights and the fifty move rule are not part of the tables:
+    positions with castling rights aren't probed, and a mate that needs
+    more than fifty moves is still reported as a win.
+*/
+
+#define TB_MAGIC "CHSTBL01"
+#define TB_VERSION 1
+
+#define TB_MAX_EXTRA 2                  // pieces beside the two kings
+#define TB_MAX_PIECES (TB_MAX_EXTRA + 2)
+#define TB_TABLE_COUNT 20               // one or two of queen, rook, bishop, knight, pawn
+
+#define TB_VALUE_DRAW    0
+#define TB_VALUE_ILLEGAL 255
+#define TB_MAX_PLIES     252            // values above that are reserved
+
+typedef struct TbHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t value_size;
+    char material[8];                   // as TbMaterialName writes it, NUL padded
+    uint64_t entries;
+} TbHeader_t;
+
+_Static_assert(sizeof(TbHeader_t) == 32, "values start 32 bytes in");
+
+// the strong side's pieces beside its king, strongest first: queen, rook, bishop, knight, pawn
+typedef struct TbMaterial {
+    int count;
+    PieceIndex_t pieces[TB_MAX_EXTRA];
+} TbMaterial_t;
+
+// a position of a table, the strong side playing white
+typedef struct TbPosition {
+    int strong_king, weak_king;
+    int pieces[TB_MAX_EXTRA];           // squares, in the order of TbMaterial_t.pieces
+    ColorIndex_t turn;                  // WHITE_IDX: the strong side is to move
+} TbPosition_t;
+
+typedef enum TbWdl {
+    TB_LOSS = -1,
+    TB_DRAW = 0,
+    TB_WIN = 1
+} TbWdl_t;
+
+typedef struct TbResult {
+    TbWdl_t wdl;                        // for the side to move
+    int plies;                          // to mate, 0 for a draw
+} TbResult_t;
+
+// "KBNK", "KNBK", "kqk" ... false if it isn't one or two pieces against a lone king
+bool TbParseMaterial(const char* name, TbMaterial_t* material);
+void TbMaterialName(const TbMaterial_t* material, char name[8]);
+
+size_t TbEntries(const TbMaterial_t* material);
+
+// index of the position, or of its mirror image that the table keeps
+size_t TbIndex(const TbMaterial_t* material, const TbPosition_t* position);
+void TbDecode(const TbMaterial_t* material, size_t index, TbPosition_t* position);
+
+static inline int TbValuePlies(uint8_t value) { return value - 1; }
+static inline uint8_t TbPliesValue(int plies) { return (uint8_t)(plies + 1); }
+
+/* probing */
+
+// maps every table found in dir, replacing the ones mapped before. returns how many there are
+int TbOpen(const char* dir);
+void TbClose(void);
+
+// most pieces, kings included, in any mapped table. 0 when none is
+int TbMaxPieces(void);
+
+// the table's value for the position, TB_VALUE_ILLEGAL if that table isn't mapped
+uint8_t TbProbeValue(const TbMaterial_t* material, const TbPosition_t* position);
+
+// false if no mapped table covers the position
+bool TbProbe(const Board_t* board, TbResult_t* result);
+
+/* generation */
+
+typedef struct TbGenStats {
+    size_t entries;
+    size_t wins, losses, draws;         // legal positions, by the side to move's result
+    int longest;                        // plies of the longest mate
+    int tables;                         // generated, the table asked for and any it needed
+} TbGenStats_t;
+
+// builds the table for material, first generating any missing table that a capture or a promotion
+// leads to, and writes each to dir as it is done. every table in dir is mapped afterwards
+bool TbGenerate(const char* dir, const TbMaterial_t* material, int threads, TbGenStats_t* stats);
+
+#endif // TABLEBASE_H
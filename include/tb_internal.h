@@ -0,0 +1,26 @@
+#ifndef TB_INTERNAL_H
+#define TB_INTERNAL_H
+
+#include "tablebase.h"
+#include "mapfile.h"
+
+// shared by the prober and the generator
+
+typedef struct TbTable {
+    TbMaterial_t material;
+    MappedFile_t file;
+    const uint8_t* values;  // NULL while the table isn't mapped
+    size_t entries;
+} TbTable_t;
+
+extern TbTable_t TbTables[TB_TABLE_COUNT]; // by TbTableId
+
+bool TbHasPawns(const TbMaterial_t* material);
+int TbTableId(const TbMaterial_t* material);
+
+void TbTablePath(const char* dir, const TbMaterial_t* material, char* path, size_t size);
+
+// maps dir's table for material into TbTables, quietly false if there is none
+bool TbMapTable(const char* dir, const TbMaterial_t* material);
+
+#endif // TB_INTERNAL_H
@@ -0,0 +1,74 @@
+#ifndef TT_H
+#define TT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "move.h"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+/*
+    Transposition table shared by every search thread.
+
+    The table is a power-of-two array of 64 byte buckets (one cache line),
+    each holding four entries. An entry is two 64-bit words: the packed
+    data and the position key XORed with that data. Readers and writers
+    never lock; a reader that sees the two words of different writes gets
+    a key mismatch and treats it as a miss. A move read from here may
+    still belong to another position after a key collision, so it must be
+    matched against generated moves before it is played.
+*/
+
+#define TT_DEFAULT_MB 16
+#define TT_BUCKET_SIZE 4
+
+typedef enum TTBound {
+    TT_BOUND_NONE = 0,
+    TT_BOUND_UPPER,  // score <= stored score (failed low)
+    TT_BOUND_LOWER,  // score >= stored score (failed high)
+    TT_BOUND_EXACT
+} TTBound_t;
+
+// decoded entry, returned by TTProbe
+typedef struct TTData {
+    PackedMove_t move;
+    int score;
+    int depth;
+    TTBound_t bound;
+} TTData_t;
+
+// (re)allocates the table with the largest power of two number of buckets
+// that fits in mb megabytes and clears it. keeps the old table on failure
+bool TTResize(size_t mb);
+void TTFree(void);
+void TTClear(void);
+
+// table size in MB, 0 if not allocated yet
+size_t TTSizeMB(void);
+
+// call once per search so entries from older searches are replaced first
+void TTNewSearch(void);
+
+bool TTProbe(uint64_t key, TTData_t* data);
+void TTStore(uint64_t key, PackedMove_t move, int score, int depth, TTBound_t bound);
+
+// used entries of this search per thousand, sampled from the first buckets
+int TTHashfull(void);
+
+// address of the bucket for key, for prefetching
+const void* TTBucketAddress(uint64_t key);
+
+// start pulling the bucket into cache before it's probed
+static inline void TTPrefetch(uint64_t key) {
+    const void* address = TTBucketAddress(key);
+#if defined(_MSC_VER)
+    _mm_prefetch((const char*)address, _MM_HINT_T0);
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
+#endif // TT_H
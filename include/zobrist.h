@@ -0,0 +1,29 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+#include "bitboard.h"
+
+typedef struct Board Board_t;
+
+/*
+    Random keys XORed together into Board_t.key.
+    The en passant file only counts when a pawn can actually take,
+    so positions that only differ by a useless ep square hash the same.
+*/
+extern uint64_t ZobristPieces[COLOR_IDX_COUNT][PIECE_IDX_COUNT][SQUARE_COUNT];
+extern uint64_t ZobristCastling[16];
+extern uint64_t ZobristEnPassant[DIM_X];
+extern uint64_t ZobristSide; // in the key when black is to move
+
+// safe to call more than once
+void InitZobrist(void);
+
+// from scratch, used on FEN load and to check the incremental key
+uint64_t ComputeKey(const Board_t* board);
+uint64_t ComputePawnKey(const Board_t* board);
+
+// true if the side to move has a pawn that can take on ep_square
+bool EnPassantCapturable(const Board_t* board);
+
+#endif // ZOBRIST_H
@@ -4,6 +4,115 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include "board.h"
+#include "gui.h"
+#include "engine.h"
+#include "book.h"
+#include "tablebase.h"
+
+// thinking time per engine move, in milliseconds
+#define ENGINE_MOVETIME 1000
+
+// optional: without it the engine searches from the first move. see include/book.h
+#define BOOK_PATH "Assets/Book/book.bin"
+
+// tables written by tbgen, see include/tablebase.h. the search uses them, and the log shows each result
+#define TABLEBASE_PATH "Assets/Tablebases"
+
+/*
+    What the engine is doing for the window. It plays engine_side; the
+    human plays the other side with the mouse. After its own move it
+    ponders on the reply it expects, and if the human plays that reply
+    the ponder search simply carries on as the real one. Positions in
+    the opening book are answered at once, without the worker.
+*/
+typedef struct EnginePlayer {
+    bool ready;
+    char engine_side;         // WHITE or BLACK, 0: off
+    uint32_t search_job;      // the job whose best move gets played
+    uint32_t ponder_job;
+    PackedMove_t ponder_move;
+
+    Book_t book;
+    bool book_ready;
+} EnginePlayer_t;
+
+static bool openBook(Book_t* book) {
+    // no book is the usual case, not an error
+    FILE* file = fopen(BOOK_PATH, "rb");
+    if(!file) return false;
+    fclose(file);
+
+    return BookOpen(BOOK_PATH, book);
+}
+
+// false if the position isn't in the book
+static bool playBookMove(EnginePlayer_t* player, Board_t* board) {
+    if(!player->book_ready) return false;
+
+    PackedMove_t move = BookPick(&player->book, board, SDL_GetPerformanceCounter());
+    return move != NO_MOVE && PlayMove(board, move);
+}
+
+static void logTablebase(const Board_t* board) {
+    TbResult_t result;
+    if(!TbProbe(board, &result)) return;
+
+    if(result.wdl == TB_DRAW) SDL_Log("Tablebase: draw");
+    else SDL_Log("Tablebase: %s %s in %d", board->turn == WHITE ? "white" : "black",
+                 result.wdl == TB_WIN ? "mates" : "is mated", (result.plies + 1) / 2);
+}
+
+// the human just moved, get the engine's answer
+static void engineReply(EnginePlayer_t* player, Board_t* board) {
+    PackedMove_t played = board->History.states[board->History.size - 1].move;
+
+    if(player->ponder_job && played == player->ponder_move) {
+        EnginePonderHit();
+        player->search_job = player->ponder_job;
+    } else {
+        if(player->ponder_job) EngineStop();
+        player->search_job = playBookMove(player, board) ? 0 : EngineSearch(board, ENGINE_MOVETIME);
+    }
+
+    player->ponder_job = 0;
+}
+
+static void engineOff(EnginePlayer_t* player) {
+    EngineStop();
+    player->engine_side = 0;
+    player->search_job = player->ponder_job = 0;
+}
+
+static void handleEngineEvent(EnginePlayer_t* player, Board_t* board, const SDL_Event* event) {
+    if(event->type == EngineInfoEvent) {
+        const EngineInfo_t* message = event->user.data1;
+
+        if(message->job == player->search_job || message->job == player->ponder_job) {
+            SDL_Log("%s depth %d score %d nodes %llu nps %llu", message->job == player->ponder_job ? "ponder" : "search",
+                    message->info.depth, message->info.score,
+                    (unsigned long long)message->info.nodes, (unsigned long long)message->info.nps);
+        }
+        return;
+    }
+
+    const EngineResult_t* message = event->user.data1;
+
+    // results of stopped jobs, or for a position that has since been taken back
+    if(message->job != player->search_job || message->key != board->key) return;
+    player->search_job = 0;
+
+    if(message->result.best_move == NO_MOVE || !PlayMove(board, message->result.best_move)) return;
+
+    if(message->result.ponder_move != NO_MOVE) {
+        static Board_t ponder_board;
+        CopyBoard(&ponder_board, board);
+
+        if(PlayMove(&ponder_board, message->result.ponder_move)) {
+            player->ponder_move = message->result.ponder_move;
+            player->ponder_job = EnginePonder(&ponder_board, ENGINE_MOVETIME);
+        }
+    }
+}
 
 int main() {
     if(SDL_Init(SDL_INIT_VIDEO) != 0) {
@@ -42,9 +151,13 @@ int main() {
     Board_t board;
     InitBoard(&board);
 
-    bool result = loadPieceTextures(renderer, &board);
+    GuiState_t gui;
+    InitGuiState(&gui);
+
+    bool result = loadPieceTextures(renderer);
     if(!result) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load all piece textures");
+        freePieceTextures();
         freeBoard(&board);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
@@ -53,6 +166,12 @@ int main() {
         return 1;
     }
 
+    // the game still works without the engine, the E key just does nothing
+    EnginePlayer_t player = { 0 };
+    player.ready = EngineStart();
+    player.book_ready = openBook(&player.book);
+    TbOpen(TABLEBASE_PATH);
+
     SDL_Event event;
     bool quit = false;
 
@@ -73,19 +192,21 @@ int main() {
                 int col = event.button.x / COL_SIZE,
                     row = event.button.y / ROW_SIZE;
                 
-                if(event.button.button == SDL_BUTTON_LEFT) {
+                // no moving for the engine while it thinks
+                if(event.button.button == SDL_BUTTON_LEFT && board.turn != player.engine_side) {
                     // new piece
                     if(curPiece == NULL) {
                         if((curPiece = getPiece(&board, row, col), curPiece)) {
 
-                            MoveList_t movelist = getLegalMoves(&board, curPiece);
-                            if(movelist.moves) {
+                            MoveList_t movelist;
+                            movelist.size = 0;
+                            getLegalMoves(&board, curPiece, &movelist);
+                            if(movelist.size) {
                                 // for(int i = 0; i < size; i++) {
                                 //     SDL_Log("Legal move %d: from (%d, %d) to (%d, %d)", i + 1, moves[i].from_row, moves[i].from_col, moves[i].to_row, moves[i].to_col);
                                 // }
                                 
-                                set_legal_moves(movelist);
-                                free(movelist.moves);
+                                set_legal_moves(&gui, &movelist);
 
                             } else {
                                 SDL_Log("No legal moves for the selected piece.");
@@ -95,10 +216,15 @@ int main() {
                     }
 
 
+                    size_t played = board.History.size;
                     movePiece(&board, curPiece, row, col);
-                    set_legal_moves((MoveList_t){NULL, 0});
+                    clear_legal_moves(&gui);
                     curPiece = NULL;
 
+                    if(board.History.size > played) logTablebase(&board);
+                    if(board.History.size > played && board.turn == player.engine_side)
+                        engineReply(&player, &board);
+
                     // if(IsCheck(&board, WHITE)) {
                     //     LOG("King is in check!");
                     // }
@@ -108,8 +234,20 @@ int main() {
 
             case SDL_KEYDOWN:
                 if(event.key.keysym.sym == SDLK_BACKSPACE) {
+                    // taking a move back hands both sides to the human
+                    if(player.engine_side) engineOff(&player);
                     UndoMove(&board);
-                } 
+                } else if(event.key.keysym.sym == SDLK_e && player.ready) {
+                    // the engine takes over the side to move, or lets go of it
+                    if(player.engine_side) {
+                        engineOff(&player);
+                    } else {
+                        player.engine_side = board.turn;
+                        player.search_job = playBookMove(&player, &board) ? 0 : EngineSearch(&board, ENGINE_MOVETIME);
+                        clear_legal_moves(&gui);
+                        curPiece = NULL;
+                    }
+                }
                 break;
 
 
@@ -121,6 +259,13 @@ int main() {
 
                 }
                 break;
+
+            default:
+                if(event.type == EngineInfoEvent || event.type == EngineResultEvent) {
+                    handleEngineEvent(&player, &board, &event);
+                    EngineReleaseEvent(&event);
+                }
+                break;
             }
 
         }
@@ -130,14 +275,18 @@ int main() {
         SDL_RenderClear(renderer);
 
         drawBoard(renderer);
-        drawHighlighted(renderer);
+        drawHighlighted(renderer, &gui);
         drawPieces(renderer, &board);
-        draw_legal_moves(renderer);
+        draw_legal_moves(renderer, &gui);
 
         SDL_RenderPresent(renderer);
         // SDL_Delay(1000 / FPS); // Delay to maintain the frame rate
     }
 
+    EngineShutdown();
+    if(player.book_ready) BookClose(&player.book);
+    TbClose();
+    freePieceTextures();
     freeBoard(&board);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
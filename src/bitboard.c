@@ -0,0 +1,69 @@
+#include "bitboard.h"
+#include "magic.h"
+
+Bitboard_t KnightAttacks[SQUARE_COUNT];
+Bitboard_t KingAttacks[SQUARE_COUNT];
+Bitboard_t PawnAttacks[COLOR_IDX_COUNT][SQUARE_COUNT];
+Bitboard_t BetweenBB[SQUARE_COUNT][SQUARE_COUNT];
+Bitboard_t LineBB[SQUARE_COUNT][SQUARE_COUNT];
+
+static bool initialized = false;
+
+static Bitboard_t LeaperAttacks(int row, int col, const int offsets[][2], int count) {
+    Bitboard_t attacks = 0;
+
+    for(int i = 0; i < count; i++) {
+        int nrow = row + offsets[i][0];
+        int ncol = col + offsets[i][1];
+
+        if(nrow >= 0 && nrow < DIM_Y && ncol >= 0 && ncol < DIM_X)
+            attacks |= BIT(SQUARE(nrow, ncol));
+    }
+
+    return attacks;
+}
+
+void InitBitboards(void) {
+    if(initialized) return;
+
+    static const int knight[8][2] = {
+        {-2, -1}, {-2, +1},
+        {-1, -2}, {-1, +2},
+        {+1, -2}, {+1, +2},
+        {+2, -1}, {+2, +1}
+    };
+
+    static const int king[8][2] = {
+        {-1, -1}, {-1, 0}, {-1, 1},
+        { 0, -1},          { 0, 1},
+        { 1, -1}, { 1, 0}, { 1, 1}
+    };
+
+    // white pawns move towards row 0, black towards row 7
+    static const int white_pawn[2][2] = { {-1, -1}, {-1, 1} };
+    static const int black_pawn[2][2] = { { 1, -1}, { 1, 1} };
+
+    for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+        int row = ROW_OF(sq), col = COL_OF(sq);
+
+        KnightAttacks[sq] = LeaperAttacks(row, col, knight, 8);
+        KingAttacks[sq] = LeaperAttacks(row, col, king, 8);
+        PawnAttacks[WHITE_IDX][sq] = LeaperAttacks(row, col, white_pawn, 2);
+        PawnAttacks[BLACK_IDX][sq] = LeaperAttacks(row, col, black_pawn, 2);
+    }
+
+    InitMagics();
+
+    for(int a = 0; a < SQUARE_COUNT; a++) {
+        for(int b = 0; b < SQUARE_COUNT; b++) {
+            for(int diagonal = 0; diagonal <= 1; diagonal++) {
+                if(!(SlidingAttacks(a, 0, diagonal) & BIT(b))) continue;
+
+                LineBB[a][b] = (SlidingAttacks(a, 0, diagonal) & SlidingAttacks(b, 0, diagonal)) | BIT(a) | BIT(b);
+                BetweenBB[a][b] = SlidingAttacks(a, BIT(b), diagonal) & SlidingAttacks(b, BIT(a), diagonal);
+            }
+        }
+    }
+
+    initialized = true;
+}
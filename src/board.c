@@ -1,160 +1,107 @@
 #include "board.h"
 #include "setting.h"
+#include "zobrist.h"
+#include "evaluate.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stddef.h>
 
-static bool is_highlighted = false;
-static SDL_Rect highlight_area = { .w = COL_SIZE, .h = ROW_SIZE }; 
-
-void drawBoard(SDL_Renderer* renderer) {
-    SDL_Rect rect;
-
-    SDL_SetRenderDrawColor(renderer, 115, 149, 82, 255);
-    for(int i = 0; i < DIM_Y; i++) {
-        for(int j = (i%2==0); j < DIM_X; j+=2) {
-            rect.x = j*COL_SIZE;
-            rect.y = i*ROW_SIZE;
-
-            rect.w = COL_SIZE;
-            rect.h = ROW_SIZE;
-
-            SDL_RenderFillRect(renderer, &rect);
-        }
-    }
-
-    SDL_SetRenderDrawColor(renderer, 235, 236, 208, 255);
-    for(int i = 0; i < DIM_Y; i++) {
-        for(int j = i%2; j < DIM_X; j+=2) {
-            rect.x = j*COL_SIZE;
-            rect.y = i*ROW_SIZE;
+static void getKings(Board_t* board) {
+    Bitboard_t white = board->bitboards[WHITE_IDX][KING_IDX];
+    Bitboard_t black = board->bitboards[BLACK_IDX][KING_IDX];
 
-            rect.w = COL_SIZE;
-            rect.h = ROW_SIZE;
+    board->WhiteKing = white ? &board->pieces[Lsb(white)] : NULL;
+    board->BlackKing = black ? &board->pieces[Lsb(black)] : NULL;
 
-            SDL_RenderFillRect(renderer, &rect);
-        }
+    if(!board->WhiteKing || !board->BlackKing) {
+        ERROR("King is missing!");
     }
 }
 
-void unhighlight_coord() {
-    is_highlighted = false;
-}
-
-void highlight_coord(int row, int col) {
+// castling rights that survive a move touching each square
+static int castle_mask[SQUARE_COUNT];
+static bool castle_mask_ready = false;
 
-    is_highlighted = true;
+// filled on the first board set up, before any search thread can call MakeMove
+static void initCastleMask(void) {
+    if(castle_mask_ready) return;
 
-    highlight_area.x = col * COL_SIZE;
-    highlight_area.y = row * ROW_SIZE;
-
-}
+    for(int sq = 0; sq < SQUARE_COUNT; sq++)
+        castle_mask[sq] = CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN | CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN;
 
-void drawHighlighted(SDL_Renderer* renderer) {
-    if(!is_highlighted) return;
+    castle_mask[SQUARE(7, 4)] &= ~(CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN);
+    castle_mask[SQUARE(7, 7)] &= ~CASTLE_WHITE_KING;
+    castle_mask[SQUARE(7, 0)] &= ~CASTLE_WHITE_QUEEN;
+    castle_mask[SQUARE(0, 4)] &= ~(CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN);
+    castle_mask[SQUARE(0, 7)] &= ~CASTLE_BLACK_KING;
+    castle_mask[SQUARE(0, 0)] &= ~CASTLE_BLACK_QUEEN;
 
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 128); // semi-transparent red
-    SDL_RenderFillRect(renderer, &highlight_area);
+    castle_mask_ready = true;
 }
 
-static PieceType_t GetPieceTypeByLetter(char c) {
-    c = SDL_tolower(c);
-
-    switch(c) {
-        case 'p': return PAWN;
-        case 'r': return ROOK;
-        case 'n': return KNIGHT;
-        case 'b': return BISHOP;
-        case 'q': return QUEEN;
-        case 'k': return KING;
-    }
+// Initialize the board with the starting position
+void InitBoard(Board_t* board) {
+    InitBoardFromFen(board, STARTING_POSITION);
 }
 
-//rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1
-static void loadFen(const char* fen, Board_t* board) {
-    SDL_Log("Loading FEN: %s", fen);
-    int row = 0, col = 0;
-    int i = 0;
-
-    for(; fen[i] != '\0' && fen[i] != ' ' && row < DIM_Y; ++i) {
-        char c = fen[i];
-
-        if(c == '/') {
-            row++;
-            col = 0;
-        } else if(SDL_isdigit(c)) { // Empty squares
-            int empty = c - '0';
-            for(int j = 0; j < empty && col < DIM_X; ++j) {
-                board->pieces[row * DIM_X + col].texture = NULL; // Empty square
-                col++;
-            }
-        } else {
-            
-            InitPiece(board->pieces + (row * DIM_X + col),
-                col, row, GetPieceTypeByLetter(c), (c >= 'a') ? BLACK : WHITE);
-
-            col++;
-        }
-    }
-
-    if(row < DIM_Y - 1 || col < DIM_X - 1) {
-        WARN("FEN string did not fill the board properly. Expected %dx%d rows, got %dx%d.", DIM_X, DIM_Y, row + 1, col + 1);
-    }
+bool InitBoardFromFen(Board_t* board, const char* fen) {
+    FenPosition_t position;
+    FenError_t error = ParseFen(fen, strlen(fen), &position, NULL);
 
-    if(fen[i] == '\0') {
-        return;
+    if(error != FEN_OK) {
+        ERROR("Invalid FEN \"%s\": %s, using the starting position", fen, FenErrorString(error));
+        ParseFen(STARTING_POSITION, strlen(STARTING_POSITION), &position, NULL);
     }
 
-    board->turn = fen[++i];
-
-    //TODO: after fetching turn, next is castling, pawn moves, half moves & full moves
+    InitBoardFromPosition(board, &position);
+    return error == FEN_OK;
 }
 
-static void getKings(Board_t* board) {
-    /* reset cached pointers before scanning */
-    
-    for(int row = 0; row < DIM_Y; row++) {
-        for(int col = 0; col < DIM_X; col++) {
-            Piece_t* target = getPiece(board, row, col);
-            if(!target || target->type != KING) continue;
-
-            if(target->color == WHITE)
-                board->WhiteKing = target;
-            else
-                board->BlackKing = target;
-        }
+void InitBoardFromPosition(Board_t* board, const FenPosition_t* position) {
+    // History is most of the board and only its size has to be reset
+    memset(board, 0, offsetof(Board_t, History));
+    board->History.size = 0;
+
+    InitBitboards();
+    InitZobrist();
+    InitEvaluation();
+    initCastleMask();
+
+    // pieces[] and the bitboards in one pass
+    for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+        int code = position->squares[sq];
+        if(code == FEN_EMPTY) continue;
+
+        ColorIndex_t c = (ColorIndex_t)((code - 1) / PIECE_IDX_COUNT);
+        PieceIndex_t p = (PieceIndex_t)((code - 1) % PIECE_IDX_COUNT);
+        board->pieces[sq] = (Piece_t){ .x = COL_OF(sq), .y = ROW_OF(sq), .type = IndexToPiece(p), .color = (c == WHITE_IDX) ? WHITE : BLACK };
+        board->bitboards[c][p] |= BIT(sq);
     }
 
-    if(!board->WhiteKing || !board->BlackKing) {
-        ERROR("King is missing!");
+    for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+        for(int p = 0; p < PIECE_IDX_COUNT; p++)
+            board->occupancy[c] |= board->bitboards[c][p];
     }
-}
+    board->occupied = board->occupancy[WHITE_IDX] | board->occupancy[BLACK_IDX];
 
-// Initialize the board with the starting position
-void InitBoard(Board_t* board) {
-    return InitBoardFromFen(board, STARTING_POSITION);
-}
-
-void InitBoardFromFen(Board_t* board, const char* fen) {
-    board->WhiteKing = NULL;
-    board->BlackKing = NULL;
-    board->History.history_size = 0; // preallocate 20. most chess games end i
-    board->History.real_history_size = 20;
-    board->History.history_state = malloc(sizeof(Piece_t*) * board->History.real_history_size);
-    board->pieces = malloc(sizeof(Piece_t)*DIM_X*DIM_Y);
-    if(!board->pieces) {
-        ERROR("Failed to allocate memory for pieces.");
-        return;
-    }
-    
-    SDL_memset(board->pieces, 0, DIM_X * DIM_Y * sizeof(Piece_t));
-
-    loadFen(fen, board);
+    board->turn = position->turn;
+    board->castling = position->castling;
+    board->ep_square = position->ep_square;
+    board->halfmove = position->halfmove;
+    board->fullmove = position->fullmove;
 
     getKings(board);
+
+    board->key = ComputeKey(board);
+    board->pawn_key = ComputePawnKey(board);
+    ComputePsq(board, &board->psq_mg, &board->psq_eg, &board->phase);
 }
 
 void printBoard(Board_t* board) {
-    if(!board || !board->pieces) {
-        ERROR("Board or pieces are NULL. Cannot print board.");
+    if(!board) {
+        ERROR("Board is NULL. Cannot print board.");
         return;
     }
 
@@ -165,7 +112,7 @@ void printBoard(Board_t* board) {
                 printf(". ");
             } else {
 
-                printf("%c ", (piece->color == WHITE) ? SDL_toupper(piece->type) : piece->type);
+                printf("%c ", (piece->color == WHITE) ? toupper(piece->type) : piece->type);
             }
         }
         printf("\n");
@@ -177,8 +124,6 @@ static inline bool WithinBounds(int row, int col) {
            col >= 0 && col < DIM_X;
 }
 
-// MoveList_t getAttackMoves(Board_t*, PieceColor_t);
-
 Piece_t* getPiece(Board_t* board, int row, int col) {
     if(!WithinBounds(row, col)) { //avoid out of bounds shit (my stupidity might cause something)
         ERROR("Attempt to access out-of-bounds coords row (y): %d, col (x): %d", row, col);
@@ -194,248 +139,252 @@ Piece_t* getPiece(Board_t* board, int row, int col) {
     return piece;
 }
 
-static Piece_t* copyP(Piece_t* piece) {
-    size_t size = sizeof(Piece_t) * DIM_X * DIM_Y;
-    Piece_t* new_piece = malloc(size);
-    if(!new_piece) {
-        return NULL;
-    }
+// the only two places pieces enter or leave a square. mailbox and bitboards change together
+static inline void PutPiece(Board_t* board, int sq, const Piece_t* piece) {
+    ColorIndex_t c = ColorToIndex(piece->color);
+    PieceIndex_t p = PieceToIndex(piece->type);
 
-    SDL_memcpy(new_piece, piece, size);
-    
-    return new_piece;
-}
+    board->pieces[sq] = *piece;
+    board->pieces[sq].x = COL_OF(sq);
+    board->pieces[sq].y = ROW_OF(sq);
 
-void movePiece(Board_t* board, Piece_t* piece, int nrow, int ncol) {
-    Piece_t* nPiece = &board->pieces[nrow * DIM_X + ncol];
-    if(nPiece == piece) {
-        return;
-    }
-    // if(piece->color != board->turn) {
-    //     return;
-    // }
-    if(piece->color == nPiece->color) {
-        return;
-    }
-    Move_t move;
-    InitMoveP(&move, piece, nrow, ncol, 0);
-    
-    if(!isValidMove( board, piece, &move )) {
-        return;
-    }
+    board->bitboards[c][p] |= BIT(sq);
+    board->occupancy[c] |= BIT(sq);
+    board->occupied |= BIT(sq);
 
-    // Free texture if capturing
-    if(nPiece->type != PIECE_NONE) {
-        freePieceTexture(nPiece);
-    }
+    board->key ^= ZobristPieces[c][p][sq];
+    if(p == PAWN_IDX) board->pawn_key ^= ZobristPieces[c][p][sq];
+    board->psq_mg += PsqMg[c][p][sq];
+    board->psq_eg += PsqEg[c][p][sq];
+    board->phase += PhaseWeights[p];
+}
 
-    // SDL_memcpy(nPiece, piece, sizeof(Piece_t));
-    
-    nPiece->type = PIECE_NONE;
+static inline void RemovePiece(Board_t* board, int sq) {
+    Piece_t* piece = &board->pieces[sq];
+    ColorIndex_t c = ColorToIndex(piece->color);
+    PieceIndex_t p = PieceToIndex(piece->type);
+
+    board->bitboards[c][p] &= ~BIT(sq);
+    board->occupancy[c] &= ~BIT(sq);
+    board->occupied &= ~BIT(sq);
 
-    nPiece->texture = piece->texture;
-    nPiece->color = piece->color;
-    nPiece->type = piece->type;
-    nPiece->x = ncol;
-    nPiece->y = nrow;
+    board->key ^= ZobristPieces[c][p][sq];
+    if(p == PAWN_IDX) board->pawn_key ^= ZobristPieces[c][p][sq];
+    board->psq_mg -= PsqMg[c][p][sq];
+    board->psq_eg -= PsqEg[c][p][sq];
+    board->phase -= PhaseWeights[p];
 
-    piece->texture = NULL;
     piece->type = PIECE_NONE;
     piece->color = 0;
     piece->x = -1;
     piece->y = -1;
+}
 
-    board->turn = (board->turn == 'w') ? 'b' : 'w';
+static inline void MoveRook(Board_t* board, int from, int to) {
+    Piece_t rook = board->pieces[from];
+    RemovePiece(board, from);
+    PutPiece(board, to, &rook);
+}
 
-    if(nPiece->type == KING) {
-        if(nPiece->color == WHITE) {
-            board->WhiteKing = nPiece;
-        } else {
-            board->BlackKing = nPiece;
-        }
+void MakeMove(Board_t* board, PackedMove_t move, UndoInfo_t* undo) {
+    int from = MoveFrom(move), to = MoveTo(move), flags = MoveFlags(move);
+    Piece_t piece = board->pieces[from];
+
+    undo->move = move;
+    undo->moved = piece;
+    undo->captured.type = PIECE_NONE;
+    undo->captured_square = NO_SQUARE;
+    undo->castling = board->castling;
+    undo->ep_square = board->ep_square;
+    undo->halfmove = board->halfmove;
+    undo->key = board->key;
+
+    // take the old rights and ep file out now, the new ones go in at the end
+    board->key ^= ZobristCastling[board->castling];
+    if(EnPassantCapturable(board))
+        board->key ^= ZobristEnPassant[COL_OF(board->ep_square)];
+
+    if(IsCapture(move)) {
+        // the pawn taken en passant sits beside us, not on the target square
+        int captured_square = (flags == FLAG_EN_PASSANT) ? SQUARE(ROW_OF(from), COL_OF(to)) : to;
+
+        undo->captured = board->pieces[captured_square];
+        undo->captured_square = captured_square;
+        RemovePiece(board, captured_square);
     }
 
-    if(board->History.history_size == board->History.real_history_size) {
-        // we need more space
-        Piece_t** tmp = realloc(
-            board->History.history_state,
-            sizeof(Piece_t*) * (board->History.real_history_size + 4)
-        );
-        if(!tmp) {
-            ERROR("Failed to reallocate memory for history state");
-            return;
-        }
-        board->History.real_history_size += 4;
-        board->History.history_state = tmp;
-    }
+    RemovePiece(board, from);
+    if(IsPromotion(move))
+        piece.type = PromotionPiece(move);
+    PutPiece(board, to, &piece);
 
-    board->History.history_state[board->History.history_size++] = copyP(board->pieces);
-}
+    if(flags == FLAG_KING_CASTLE)
+        MoveRook(board, SQUARE(ROW_OF(from), DIM_X - 1), SQUARE(ROW_OF(from), COL_OF(to) - 1));
+    else if(flags == FLAG_QUEEN_CASTLE)
+        MoveRook(board, SQUARE(ROW_OF(from), 0), SQUARE(ROW_OF(from), COL_OF(to) + 1));
 
-bool loadPieceTextures(SDL_Renderer* renderer, Board_t* board) {
-    if(!board || !board->pieces) {
-        ERROR("Board or pieces are NULL. Cannot load piece textures.");
-        return false;
-    }
+    board->castling &= castle_mask[from] & castle_mask[to];
 
-    for(int i = 0; i < DIM_X * DIM_Y; i++) {
-        Piece_t* piece = &board->pieces[i];
-        if(piece->type != PIECE_NONE && piece->texture == NULL) {
-            loadPieceTexture(renderer, piece);
+    board->ep_square = (flags == FLAG_DOUBLE_PUSH) ? (from + to) / 2 : NO_SQUARE;
 
-            if(piece->texture == NULL) {
+    if(piece.type == PAWN || undo->captured.type != PIECE_NONE)
+        board->halfmove = 0;
+    else
+        board->halfmove++;
 
-                ERROR("Failed to load texture for piece at (%d, %d).", piece->x, piece->y);
-                return false;
+    if(board->turn == BLACK)
+        board->fullmove++;
+    board->turn = (board->turn == 'w') ? 'b' : 'w';
 
-            }
-        }
+    board->key ^= ZobristSide ^ ZobristCastling[board->castling];
+    if(EnPassantCapturable(board))
+        board->key ^= ZobristEnPassant[COL_OF(board->ep_square)];
+
+    if(piece.type == KING) {
+        if(piece.color == WHITE)
+            board->WhiteKing = &board->pieces[to];
+        else
+            board->BlackKing = &board->pieces[to];
     }
+}
 
-    return true;
+void UnmakeMove(Board_t* board, const UndoInfo_t* undo) {
+    int from = MoveFrom(undo->move), to = MoveTo(undo->move), flags = MoveFlags(undo->move);
+
+    board->turn = (board->turn == 'w') ? 'b' : 'w';
+    if(board->turn == BLACK)
+        board->fullmove--;
+
+    if(flags == FLAG_KING_CASTLE)
+        MoveRook(board, SQUARE(ROW_OF(from), COL_OF(to) - 1), SQUARE(ROW_OF(from), DIM_X - 1));
+    else if(flags == FLAG_QUEEN_CASTLE)
+        MoveRook(board, SQUARE(ROW_OF(from), COL_OF(to) + 1), SQUARE(ROW_OF(from), 0));
+
+    // the saved piece also undoes a promotion
+    RemovePiece(board, to);
+    PutPiece(board, from, &undo->moved);
+
+    if(undo->captured.type != PIECE_NONE)
+        PutPiece(board, undo->captured_square, &undo->captured);
+
+    board->castling = undo->castling;
+    board->ep_square = undo->ep_square;
+    board->halfmove = undo->halfmove;
+    board->key = undo->key; // PutPiece/RemovePiece XORed along the way, the saved key is exact
+
+    if(undo->moved.type == KING) {
+        if(undo->moved.color == WHITE)
+            board->WhiteKing = &board->pieces[from];
+        else
+            board->BlackKing = &board->pieces[from];
+    }
 }
 
-void drawPieces(SDL_Renderer* renderer, Board_t* board) {
-    if(!board || !board->pieces) {
-        ERROR("Board or pieces are NULL. Cannot draw pieces.");
+void movePiece(Board_t* board, Piece_t* piece, int nrow, int ncol) {
+    Piece_t* nPiece = &board->pieces[nrow * DIM_X + ncol];
+    if(nPiece == piece) {
+        return;
+    }
+    // if(piece->color != board->turn) {
+    //     return;
+    // }
+    if(piece->color == nPiece->color) {
+        return;
+    }
+    Move_t move;
+    InitMoveP(&move, piece, nrow, ncol, piece->type == PAWN && (nrow == 0 || nrow == DIM_Y - 1));
+    
+    PackedMove_t packed = MatchMove(board, &move);
+    if(packed == NO_MOVE) {
         return;
     }
 
-    for(int i = 0; i < DIM_X * DIM_Y; i++) {
-        Piece_t* piece = &board->pieces[i];
-        if(piece->texture) {
-            drawPiece(renderer, piece);
-        }
+    PlayMove(board, packed);
+}
+
+bool PlayMove(Board_t* board, PackedMove_t move) {
+    if(board->History.size == MAX_GAME_PLY) {
+        ERROR("History is full, refusing to play more than %d moves", MAX_GAME_PLY);
+        return false;
     }
+
+    MakeMove(board, move, &board->History.states[board->History.size++]);
+    return true;
 }
 
-void getFEN(Board_t* board, char buffer[]) {
-    int size = 0;
-    for (int row = 0; row < DIM_Y; row++) {
-        int skip = 0;
-        for (int col = 0; col < DIM_X; col++) {
-            Piece_t* piece = &board->pieces[row * DIM_X + col];
+size_t WriteFen(const Board_t* board, char* buffer, size_t size) {
+    char fen[FEN_MAX_LENGTH];
+    size_t length = 0;
 
-            if (piece->type != PIECE_NONE) {
-               if (skip > 0)
-                    buffer[size++] = '0' + skip;
+    for(int row = 0; row < DIM_Y; row++) {
+        int empty = 0;
+
+        for(int col = 0; col < DIM_X; col++) {
+            const Piece_t* piece = &board->pieces[SQUARE(row, col)];
 
-                buffer[size++] = (piece->color == WHITE) ? SDL_toupper(piece->type) : piece->type;
-                skip = 0;
-                
-            } else
-                skip++;
+            if(piece->type == PIECE_NONE) {
+                empty++;
+                continue;
+            }
 
+            if(empty > 0) fen[length++] = (char)('0' + empty);
+            fen[length++] = (piece->color == WHITE) ? (char)toupper(piece->type) : (char)piece->type;
+            empty = 0;
         }
-        if (skip > 0)
-            buffer[size++] = '0' + skip;
 
-        if (row != DIM_Y - 1)
-            buffer[size++] = '/';
+        if(empty > 0) fen[length++] = (char)('0' + empty);
+        if(row != DIM_Y - 1) fen[length++] = '/';
     }
-    buffer[size] = '\0';
-}
 
-void UndoMove(Board_t *board) {
-    if(board->History.history_size == 0) {
-        return;
+    fen[length++] = ' ';
+    fen[length++] = board->turn;
+    fen[length++] = ' ';
+
+    if(board->castling == 0) fen[length++] = '-';
+    if(board->castling & CASTLE_WHITE_KING) fen[length++] = 'K';
+    if(board->castling & CASTLE_WHITE_QUEEN) fen[length++] = 'Q';
+    if(board->castling & CASTLE_BLACK_KING) fen[length++] = 'k';
+    if(board->castling & CASTLE_BLACK_QUEEN) fen[length++] = 'q';
+
+    fen[length++] = ' ';
+    if(board->ep_square == NO_SQUARE) {
+        fen[length++] = '-';
+    } else {
+        fen[length++] = (char)('a' + COL_OF(board->ep_square));
+        fen[length++] = (char)('0' + DIM_Y - ROW_OF(board->ep_square));
     }
 
-    int size = --board->History.history_size;
-    Piece_t* latest = board->History.history_state[size];
+    // placement is at most 71 characters, so the clocks always fit in the rest
+    length += (size_t)snprintf(fen + length, sizeof(fen) - length, " %d %d", board->halfmove, board->fullmove);
 
-    free(board->pieces);               /* free current snapshot */
-    board->pieces = latest;            /* install previous */
+    if(length >= size) return 0;
 
-    board->History.history_state[size] = NULL;  /* prevent double free */
-    board->turn = (board->turn == 'w') ? 'b' : 'w';
-    
-    getKings(board);
-    // board[--board->History.history_size];
-    // if(board->history.size == 0) return;
-
-
-    // Move_t* latest = pop(&board->history);
-    
-    // int from =  latest->to_row * DIM_X + latest->to_col;
-    // int to = latest->from_row * DIM_X + latest->from_col;
-    // // Piece_t* target = &board->pieces[latest->from_row * DIM_X + latest->from_col]; // old
-    // // Piece_t* target2 = &board->pieces[latest->to_row * DIM_X + latest->to_col]; // new
-
-    // SDL_memcpy(board->pieces + to, board->pieces + from, sizeof(Piece_t));
-
-    // Piece_t temp = board->pieces[to];
-    // board->pieces[to] = board->pieces[from];
-    // board->pieces[from] = temp;
+    memcpy(buffer, fen, length + 1);
+    return length;
+}
 
-/*
-Critical logic error in UndoMove function implementation.
-The current implementation has several issues:
+void UndoMove(Board_t *board) {
+    if(board->History.size == 0) {
+        return;
+    }
 
-The from and to indices calculation appears to be swapped (line 322-323)
-The memcpy followed by swap operations are redundant and incorrect
-The function doesn't restore captured pieces or handle special moves (castling, en passant)
-The turn indicator isn't being reverted
-The minimal fix for the basic move reversal would be:
+    UnmakeMove(board, &board->History.states[--board->History.size]);
+}
 
-void UndoMove(Board_t *board) {
-     if(board->history.size == 0) return;
-     Move_t* latest = pop(&board->history);
-     
--    int from =  latest->to_row * DIM_X + latest->to_col;
--    int to = latest->from_row * DIM_X + latest->from_col;
--    // Piece_t* target = &board->pieces[latest->from_row * DIM_X + latest->from_col]; // old
--    // Piece_t* target2 = &board->pieces[latest->to_row * DIM_X + latest->to_col]; // new
--
--    SDL_memcpy(board->pieces + to, board->pieces + from, sizeof(Piece_t));
--
--    Piece_t temp = board->pieces[to];
--    board->pieces[to] = board->pieces[from];
--    board->pieces[from] = temp;
-+    int from_idx = latest->from_row * DIM_X + latest->from_col;
-+    int to_idx = latest->to_row * DIM_X + latest->to_col;
-+    
-+    // Move the piece back to its original position
-+    board->pieces[from_idx] = board->pieces[to_idx];
-+    
-+    // Clear the destination square (or restore captured piece if tracking it)
-+    board->pieces[to_idx].type = PIECE_NONE;
-+    board->pieces[to_idx].texture = NULL;
-+    
-+    // Update piece coordinates
-+    board->pieces[from_idx].x = latest->from_col;
-+    board->pieces[from_idx].y = latest->from_row;
-+    
-+    // Update king position if it was moved
-+    if(board->pieces[from_idx].type == KING) {
-+        if(board->pieces[from_idx].color == WHITE) {
-+            board->WhiteKing = &board->pieces[from_idx];
-+        } else {
-+            board->BlackKing = &board->pieces[from_idx];
-+        }
-+    }
-+    
-+    // Revert the turn
-+    board->turn = (board->turn == 'w') ? 'b' : 'w';
- }
-However, this implementation is still incomplete as it doesn't handle:
-
-Restoring captured pieces 
-Special moves (castling, en passant)
-Pawn promotion
-Would you like me to provide a more complete implementation that handles captured pieces and special moves?
-*/
+void CopyBoard(Board_t* dst, const Board_t* src) {
+    // History is most of the board, only the moves in it are copied
+    memcpy(dst, src, offsetof(Board_t, History));
+    memcpy(dst->History.states, src->History.states, src->History.size * sizeof(UndoInfo_t));
+    dst->History.size = src->History.size;
 
+    // the king pointers point into pieces[], they have to follow the copy
+    dst->WhiteKing = src->WhiteKing ? &dst->pieces[src->WhiteKing - src->pieces] : NULL;
+    dst->BlackKing = src->BlackKing ? &dst->pieces[src->BlackKing - src->pieces] : NULL;
 }
 
 void freeBoard(Board_t* board) {
     if(!board) return;
 
-    if(board->pieces)
-        for(int i = 0; i < DIM_X * DIM_Y; i++)
-            if(board->pieces[i].texture)
-                freePieceTexture(&board->pieces[i]);
-
-    if(board->History.real_history_size != 0)
-        free(board->History.history_state);
-}
\ No newline at end of file
+    // everything lives inside Board_t, nothing to release but the history
+    board->History.size = 0;
+}
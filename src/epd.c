@@ -0,0 +1,146 @@
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "epd.h"
+#include "mapfile.h"
+#include "setting.h"
+
+#define MAX_LOAD_THREADS 256
+
+typedef struct EpdChunk {
+    const char* begin;
+    const char* end;      // just past the chunk's last newline, or the end of the file
+
+    FenPosition_t* out;   // room for one position per line
+    size_t lines;
+    size_t count;
+    size_t rejected;
+} EpdChunk_t;
+
+// lines in [begin, end), the last one counts without its newline
+static size_t countLines(const char* begin, const char* end) {
+    size_t lines = 0;
+
+    for(const char* p = begin; p < end; ) {
+        const char* newline = memchr(p, '\n', (size_t)(end - p));
+        lines++;
+        if(!newline) break;
+        p = newline + 1;
+    }
+
+    return lines;
+}
+
+static int parseChunk(void* data) {
+    EpdChunk_t* chunk = data;
+
+    for(const char* p = chunk->begin; p < chunk->end; ) {
+        const char* newline = memchr(p, '\n', (size_t)(chunk->end - p));
+        const char* line_end = newline ? newline : chunk->end;
+
+        const char* q = p;
+        while(q < line_end && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+
+        if(q < line_end && *q != '#') {
+            if(ParseFen(q, (size_t)(line_end - q), &chunk->out[chunk->count], NULL) == FEN_OK)
+                chunk->count++;
+            else
+                chunk->rejected++;
+        }
+
+        p = line_end + 1;
+    }
+
+    return 0;
+}
+
+static int countChunk(void* data) {
+    EpdChunk_t* chunk = data;
+    chunk->lines = countLines(chunk->begin, chunk->end);
+    return 0;
+}
+
+// runs work on every chunk, the first on the calling thread
+static void runChunks(EpdChunk_t* chunks, int count, thrd_start_t work) {
+    thrd_t handles[MAX_LOAD_THREADS];
+    bool started[MAX_LOAD_THREADS] = { false };
+
+    for(int i = 1; i < count; i++)
+        started[i] = thrd_create(&handles[i], work, &chunks[i]) == thrd_success;
+
+    work(&chunks[0]);
+
+    for(int i = 1; i < count; i++) {
+        if(started[i]) thrd_join(handles[i], NULL);
+        else work(&chunks[i]);
+    }
+}
+
+bool LoadEpdFile(const char* path, int threads, EpdSet_t* set) {
+    set->positions = NULL;
+    set->count = set->rejected = 0;
+
+    MappedFile_t file;
+    if(!MapFile(path, &file, true)) {
+        ERROR("Failed to open EPD file %s", path);
+        return false;
+    }
+
+    if(threads < 1) threads = 1;
+    if(threads > MAX_LOAD_THREADS) threads = MAX_LOAD_THREADS;
+
+    const char* text = (const char*)file.data;
+    const char* end = text + file.size;
+
+    // even byte ranges, each pushed forward to the start of a line
+    EpdChunk_t chunks[MAX_LOAD_THREADS];
+    const char* begin = text;
+    for(int i = 0; i < threads; i++) {
+        const char* stop = (i == threads - 1) ? end : text + file.size * (size_t)(i + 1) / (size_t)threads;
+        if(stop < begin) stop = begin;
+        if(stop < end) {
+            const char* newline = memchr(stop, '\n', (size_t)(end - stop));
+            stop = newline ? newline + 1 : end;
+        }
+
+        chunks[i] = (EpdChunk_t){ .begin = begin, .end = stop };
+        begin = stop;
+    }
+
+    runChunks(chunks, threads, countChunk);
+
+    size_t total = 0;
+    for(int i = 0; i < threads; i++) total += chunks[i].lines;
+
+    FenPosition_t* positions = malloc((total ? total : 1) * sizeof(FenPosition_t));
+    if(!positions) {
+        ERROR("Out of memory for %zu positions", total);
+        UnmapFile(&file);
+        return false;
+    }
+
+    size_t offset = 0;
+    for(int i = 0; i < threads; i++) {
+        chunks[i].out = positions + offset;
+        offset += chunks[i].lines;
+    }
+
+    runChunks(chunks, threads, parseChunk);
+
+    // close the gaps left by blank and rejected lines
+    for(int i = 0; i < threads; i++) {
+        memmove(positions + set->count, chunks[i].out, chunks[i].count * sizeof(FenPosition_t));
+        set->count += chunks[i].count;
+        set->rejected += chunks[i].rejected;
+    }
+
+    UnmapFile(&file);
+    set->positions = positions;
+    return true;
+}
+
+void FreeEpdSet(EpdSet_t* set) {
+    free(set->positions);
+    set->positions = NULL;
+    set->count = set->rejected = 0;
+}
@@ -0,0 +1,305 @@
+#include <string.h>
+#include "fen.h"
+#include "board.h"
+
+// per placement character: the code it leaves on its square and how many squares it covers.
+// pieces cover one, digits cover that many empty ones, anything else covers none
+typedef struct PlacementChar {
+    uint8_t code;
+    uint8_t step;
+} PlacementChar_t;
+
+#define PIECE_CHAR(color_index, piece_index) { FEN_PIECE(color_index, piece_index), 1 }
+
+static const PlacementChar_t placement_chars[256] = {
+    ['P'] = PIECE_CHAR(WHITE_IDX, PAWN_IDX),   ['p'] = PIECE_CHAR(BLACK_IDX, PAWN_IDX),
+    ['N'] = PIECE_CHAR(WHITE_IDX, KNIGHT_IDX), ['n'] = PIECE_CHAR(BLACK_IDX, KNIGHT_IDX),
+    ['B'] = PIECE_CHAR(WHITE_IDX, BISHOP_IDX), ['b'] = PIECE_CHAR(BLACK_IDX, BISHOP_IDX),
+    ['R'] = PIECE_CHAR(WHITE_IDX, ROOK_IDX),   ['r'] = PIECE_CHAR(BLACK_IDX, ROOK_IDX),
+    ['Q'] = PIECE_CHAR(WHITE_IDX, QUEEN_IDX),  ['q'] = PIECE_CHAR(BLACK_IDX, QUEEN_IDX),
+    ['K'] = PIECE_CHAR(WHITE_IDX, KING_IDX),   ['k'] = PIECE_CHAR(BLACK_IDX, KING_IDX),
+    ['1'] = { FEN_EMPTY, 1 }, ['2'] = { FEN_EMPTY, 2 }, ['3'] = { FEN_EMPTY, 3 }, ['4'] = { FEN_EMPTY, 4 },
+    ['5'] = { FEN_EMPTY, 5 }, ['6'] = { FEN_EMPTY, 6 }, ['7'] = { FEN_EMPTY, 7 }, ['8'] = { FEN_EMPTY, 8 },
+};
+
+#undef PIECE_CHAR
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline const char* skipSpaces(const char* p, const char* end) {
+    while(p < end && isSpace(*p)) p++;
+    return p;
+}
+
+// the field has ended: end of text or whitespace
+static inline bool fieldEnd(const char* p, const char* end) {
+    return p == end || isSpace(*p);
+}
+
+static const char* parsePlacement(const char* p, const char* end, FenPosition_t* position, FenError_t* error) {
+    int row = 0, col = 0;
+    uint8_t* squares = position->squares;
+
+    memset(squares, FEN_EMPTY, sizeof(position->squares));
+    *error = FEN_ERROR_PLACEMENT;
+
+    // one lookup per character and no branch on its kind: digits write FEN_EMPTY, which is already there
+    for(; p < end; p++) {
+        PlacementChar_t c = placement_chars[(unsigned char)*p];
+
+        if(c.step == 0) {
+            if(*p != '/') break;
+            if(col != DIM_X || ++row == DIM_Y) return p;
+            col = 0;
+            continue;
+        }
+
+        if(col + c.step > DIM_X) return p;
+        squares[SQUARE(row, col)] = c.code;
+        col += c.step;
+    }
+
+    if(!fieldEnd(p, end) || row != DIM_Y - 1 || col != DIM_X) return p;
+
+    *error = FEN_OK;
+    return p;
+}
+
+// the king and rook each castling right needs on their home squares
+static const struct { int right, king, rook; uint8_t king_code, rook_code; } castling_homes[] = {
+    { CASTLE_WHITE_KING,  SQUARE(7, 4), SQUARE(7, 7), FEN_PIECE(WHITE_IDX, KING_IDX), FEN_PIECE(WHITE_IDX, ROOK_IDX) },
+    { CASTLE_WHITE_QUEEN, SQUARE(7, 4), SQUARE(7, 0), FEN_PIECE(WHITE_IDX, KING_IDX), FEN_PIECE(WHITE_IDX, ROOK_IDX) },
+    { CASTLE_BLACK_KING,  SQUARE(0, 4), SQUARE(0, 7), FEN_PIECE(BLACK_IDX, KING_IDX), FEN_PIECE(BLACK_IDX, ROOK_IDX) },
+    { CASTLE_BLACK_QUEEN, SQUARE(0, 4), SQUARE(0, 0), FEN_PIECE(BLACK_IDX, KING_IDX), FEN_PIECE(BLACK_IDX, ROOK_IDX) },
+};
+
+#define CASTLING_HOMES (sizeof(castling_homes) / sizeof(castling_homes[0]))
+
+static inline bool castlingHome(const FenPosition_t* position, size_t i) {
+    return position->squares[castling_homes[i].king] == castling_homes[i].king_code
+        && position->squares[castling_homes[i].rook] == castling_homes[i].rook_code;
+}
+
+static const char* parseCastling(const char* p, const char* end, FenPosition_t* position, FenError_t* error) {
+    position->castling = 0;
+    *error = FEN_ERROR_CASTLING;
+
+    if(p < end && *p == '-') {
+        p++;
+    } else {
+        for(; !fieldEnd(p, end); p++) {
+            int right;
+            switch(*p) {
+                case 'K': right = CASTLE_WHITE_KING; break;
+                case 'Q': right = CASTLE_WHITE_QUEEN; break;
+                case 'k': right = CASTLE_BLACK_KING; break;
+                case 'q': right = CASTLE_BLACK_QUEEN; break;
+                default: return p;
+            }
+
+            if(position->castling & right) return p;
+            position->castling |= right;
+        }
+
+        if(position->castling == 0) return p;
+    }
+
+    if(!fieldEnd(p, end)) return p;
+
+    // only rights the pieces on the board can still use, ValidatePosition wants the rest gone
+    for(size_t i = 0; i < CASTLING_HOMES; i++) {
+        if(!castlingHome(position, i)) position->castling &= ~castling_homes[i].right;
+    }
+
+    *error = FEN_OK;
+    return p;
+}
+
+static const char* parseEnPassant(const char* p, const char* end, FenPosition_t* position, FenError_t* error) {
+    position->ep_square = NO_SQUARE;
+    *error = FEN_ERROR_EN_PASSANT;
+
+    if(p < end && *p == '-') {
+        p++;
+    } else {
+        // the rank and the pawn behind it are left to ValidatePosition
+        if(end - p < 2 || p[0] < 'a' || p[0] > 'h' || p[1] < '1' || p[1] > '8') return p;
+
+        position->ep_square = (int8_t)SQUARE(DIM_Y - (p[1] - '0'), p[0] - 'a');
+        p += 2;
+    }
+
+    if(!fieldEnd(p, end)) return p;
+
+    *error = FEN_OK;
+    return p;
+}
+
+// a clock if the next field is all digits, otherwise nothing is read and the field is left for the caller
+static const char* parseClock(const char* p, const char* end, uint16_t* clock, bool* found, FenError_t* error) {
+    const char* start = skipSpaces(p, end);
+    const char* q = start;
+    uint32_t value = 0;
+
+    *found = false;
+    *error = FEN_OK;
+
+    while(q < end && *q >= '0' && *q <= '9') {
+        value = value * 10 + (uint32_t)(*q++ - '0');
+        if(value > UINT16_MAX) {
+            *error = FEN_ERROR_CLOCK;
+            return q;
+        }
+    }
+
+    if(q == start || !fieldEnd(q, end)) return p;
+
+    *clock = (uint16_t)value;
+    *found = true;
+    return q;
+}
+
+static inline bool onBoard(int row, int col) {
+    return row >= 0 && row < DIM_Y && col >= 0 && col < DIM_X;
+}
+
+// whether the pieces of color attack sq. walks the squares directly, the parser doesn't rely on the attack tables
+static bool squareAttacked(const uint8_t* squares, int sq, int color) {
+    static const int knight[8][2] = { {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1} };
+    static const int king[8][2] = { {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1} };
+    int row = ROW_OF(sq), col = COL_OF(sq);
+
+    // a white pawn attacks the row above it, a black one the row below
+    int pawn_row = row + (color == WHITE_IDX ? 1 : -1);
+    for(int dc = -1; dc <= 1; dc += 2) {
+        if(onBoard(pawn_row, col + dc) && squares[SQUARE(pawn_row, col + dc)] == FEN_PIECE(color, PAWN_IDX)) return true;
+    }
+
+    for(int i = 0; i < 8; i++) {
+        int r = row + knight[i][0], c = col + knight[i][1];
+        if(onBoard(r, c) && squares[SQUARE(r, c)] == FEN_PIECE(color, KNIGHT_IDX)) return true;
+        r = row + king[i][0], c = col + king[i][1];
+        if(onBoard(r, c) && squares[SQUARE(r, c)] == FEN_PIECE(color, KING_IDX)) return true;
+    }
+
+    // king[] doubles as the eight ray directions
+    for(int i = 0; i < 8; i++) {
+        bool diagonal = king[i][0] != 0 && king[i][1] != 0;
+        uint8_t slider = FEN_PIECE(color, diagonal ? BISHOP_IDX : ROOK_IDX), queen = FEN_PIECE(color, QUEEN_IDX);
+
+        for(int r = row + king[i][0], c = col + king[i][1]; onBoard(r, c); r += king[i][0], c += king[i][1]) {
+            uint8_t code = squares[SQUARE(r, c)];
+            if(code == FEN_EMPTY) continue;
+            if(code == slider || code == queen) return true;
+            break;
+        }
+    }
+
+    return false;
+}
+
+// the side that just moved can't have left its king attacked. this also rules out kings standing side by side
+static bool opponentInCheck(const FenPosition_t* position) {
+    int them = (position->turn == WHITE) ? BLACK_IDX : WHITE_IDX;
+    uint8_t their_king = FEN_PIECE(them, KING_IDX);
+
+    for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+        if(position->squares[sq] == their_king) return squareAttacked(position->squares, sq, them ^ 1);
+    }
+    return false;
+}
+
+static FenError_t parseFields(const char** cursor, const char* end, FenPosition_t* position) {
+    FenError_t error;
+    const char* p = skipSpaces(*cursor, end);
+
+    p = *cursor = parsePlacement(p, end, position, &error);
+    if(error != FEN_OK) return error;
+
+    // side to move
+    p = skipSpaces(p, end);
+    if(p == end || (*p != 'w' && *p != 'b') || !fieldEnd(p + 1, end)) return FEN_ERROR_SIDE;
+    position->turn = (*p++ == 'w') ? WHITE : BLACK;
+    *cursor = p;
+
+    p = *cursor = parseCastling(skipSpaces(p, end), end, position, &error);
+    if(error != FEN_OK) return error;
+
+    p = *cursor = parseEnPassant(skipSpaces(p, end), end, position, &error);
+    if(error != FEN_OK) return error;
+
+    position->halfmove = 0;
+    position->fullmove = 1;
+
+    bool found;
+    p = *cursor = parseClock(p, end, &position->halfmove, &found, &error);
+    if(error != FEN_OK || !found) return error;
+
+    *cursor = parseClock(p, end, &position->fullmove, &found, &error);
+    if(position->fullmove == 0) position->fullmove = 1;
+
+    return error;
+}
+
+FenError_t ValidatePosition(const FenPosition_t* position) {
+    const uint8_t* squares = position->squares;
+
+    const uint8_t white_pawn = FEN_PIECE(WHITE_IDX, PAWN_IDX), black_pawn = FEN_PIECE(BLACK_IDX, PAWN_IDX);
+    for(int i = 0; i < DIM_X; i++) {
+        uint8_t top = squares[SQUARE(0, i)], bottom = squares[SQUARE(DIM_Y - 1, i)];
+        if(top == white_pawn || top == black_pawn || bottom == white_pawn || bottom == black_pawn) return FEN_ERROR_PLACEMENT;
+    }
+
+    int kings[COLOR_IDX_COUNT] = { 0, 0 };
+    for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+        kings[WHITE_IDX] += squares[sq] == FEN_PIECE(WHITE_IDX, KING_IDX);
+        kings[BLACK_IDX] += squares[sq] == FEN_PIECE(BLACK_IDX, KING_IDX);
+    }
+    if(kings[WHITE_IDX] != 1 || kings[BLACK_IDX] != 1) return FEN_ERROR_KINGS;
+
+    if(position->turn != WHITE && position->turn != BLACK) return FEN_ERROR_SIDE;
+    if(opponentInCheck(position)) return FEN_ERROR_CHECK;
+
+    for(size_t i = 0; i < CASTLING_HOMES; i++) {
+        if((position->castling & castling_homes[i].right) && !castlingHome(position, i)) return FEN_ERROR_CASTLING;
+    }
+
+    if(position->ep_square != NO_SQUARE) {
+        // behind a pawn of the side that just moved: rank 6 with white to move, rank 3 with black
+        bool white = position->turn == WHITE;
+        int ep = position->ep_square;
+        if(ep < 0 || ep >= SQUARE_COUNT || ROW_OF(ep) != (white ? 2 : DIM_Y - 3)) return FEN_ERROR_EN_PASSANT;
+        if(squares[ep + (white ? DIM_X : -DIM_X)] != FEN_PIECE(white ? BLACK_IDX : WHITE_IDX, PAWN_IDX)) return FEN_ERROR_EN_PASSANT;
+
+        // and the pawn passed over the ep square from the one behind it, so both are empty
+        if(squares[ep] != FEN_EMPTY || squares[ep + (white ? -DIM_X : DIM_X)] != FEN_EMPTY) return FEN_ERROR_EN_PASSANT;
+    }
+
+    return position->fullmove > 0 ? FEN_OK : FEN_ERROR_CLOCK;
+}
+
+FenError_t ParseFen(const char* text, size_t length, FenPosition_t* position, size_t* consumed) {
+    const char* cursor = text;
+    FenError_t error = parseFields(&cursor, text + length, position);
+    if(error == FEN_OK) error = ValidatePosition(position);
+
+    if(consumed) *consumed = (size_t)(cursor - text);
+    return error;
+}
+
+const char* FenErrorString(FenError_t error) {
+    switch(error) {
+        case FEN_OK:               return "ok";
+        case FEN_ERROR_PLACEMENT:  return "bad piece placement";
+        case FEN_ERROR_KINGS:      return "each side needs exactly one king";
+        case FEN_ERROR_SIDE:       return "side to move must be w or b";
+        case FEN_ERROR_CHECK:      return "the side not to move is in check";
+        case FEN_ERROR_CASTLING:   return "bad castling rights";
+        case FEN_ERROR_EN_PASSANT: return "bad en passant square";
+        case FEN_ERROR_CLOCK:      return "clock out of range";
+    }
+
+    return "unknown error";
+}
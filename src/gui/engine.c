@@ -0,0 +1,204 @@
+#include <stdatomic.h>
+#include "engine.h"
+
+typedef enum EngineJobType {
+    ENGINE_JOB_SEARCH,
+    ENGINE_JOB_PONDER,
+    ENGINE_JOB_QUIT
+} EngineJobType_t;
+
+typedef struct EngineJob {
+    EngineJobType_t type;
+    uint32_t id;
+    int64_t movetime;
+    Board_t board;
+} EngineJob_t;
+
+Uint32 EngineInfoEvent = (Uint32)-1;
+Uint32 EngineResultEvent = (Uint32)-1;
+
+/*
+    The SDL loop only writes tail and the slots in front of it, the
+    worker only writes head. A slot is handed back once the worker has
+    finished the job in it, so the search reads the board in place.
+    The semaphore only lets the worker sleep while the ring is empty.
+*/
+static struct {
+    EngineJob_t jobs[ENGINE_QUEUE_SIZE];
+    _Atomic uint32_t head; // next job the worker runs
+    _Atomic uint32_t tail; // next free slot
+
+    SDL_sem* pending;
+    SDL_Thread* thread;
+
+    // SDL loop only
+    uint32_t last_id;
+    uint32_t last_ponder_id;
+
+    // jobs with an id up to these were stopped / had their ponderhit
+    atomic_uint cancelled;
+    atomic_uint ponderhit;
+
+    // handed to the running search through SearchLimits_t
+    atomic_bool stop;
+    atomic_bool ponder;
+} engine;
+
+static void sendEvent(Uint32 type, void* data) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = type;
+    event.user.data1 = data;
+
+    if(SDL_PushEvent(&event) <= 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Dropped an engine event: %s", SDL_GetError());
+        SDL_free(data);
+    }
+}
+
+// runs on the worker, after every finished iteration
+static void reportInfo(const SearchInfo_t* info, void* data) {
+    const EngineJob_t* job = data;
+
+    EngineInfo_t* message = SDL_malloc(sizeof(EngineInfo_t));
+    if(!message) return;
+
+    message->job = job->id;
+    message->info = *info;
+    sendEvent(EngineInfoEvent, message);
+}
+
+static void runJob(EngineJob_t* job) {
+    // reset first, then look at the ids: a stop that raced with the reset is still seen through them
+    atomic_store(&engine.stop, false);
+    atomic_store(&engine.ponder, job->type == ENGINE_JOB_PONDER);
+
+    if(job->id <= atomic_load(&engine.cancelled)) return;
+    if(job->id <= atomic_load(&engine.ponderhit)) atomic_store(&engine.ponder, false);
+
+    SearchLimits_t limits = { 0 };
+    limits.movetime = job->movetime;
+    limits.stop = &engine.stop;
+    limits.ponder = (job->type == ENGINE_JOB_PONDER) ? &engine.ponder : NULL;
+    limits.report = reportInfo;
+    limits.report_data = job;
+
+    SearchResult_t result = SearchPosition(&job->board, &limits);
+
+    EngineResult_t* message = SDL_malloc(sizeof(EngineResult_t));
+    if(!message) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory, lost the result of engine job %u", job->id);
+        return;
+    }
+
+    message->job = job->id;
+    message->ponder = job->type == ENGINE_JOB_PONDER;
+    message->key = job->board.key;
+    message->result = result;
+    sendEvent(EngineResultEvent, message);
+}
+
+static int engineMain(void* data) {
+    (void)data;
+
+    for(;;) {
+        SDL_SemWait(engine.pending);
+
+        uint32_t head = atomic_load_explicit(&engine.head, memory_order_relaxed);
+        if(head == atomic_load_explicit(&engine.tail, memory_order_acquire)) continue;
+
+        EngineJob_t* job = &engine.jobs[head & (ENGINE_QUEUE_SIZE - 1)];
+        bool quit = job->type == ENGINE_JOB_QUIT;
+        if(!quit) runJob(job);
+
+        atomic_store_explicit(&engine.head, head + 1, memory_order_release);
+        if(quit) return 0;
+    }
+}
+
+static uint32_t pushJob(EngineJobType_t type, const Board_t* board, int64_t movetime) {
+    uint32_t tail = atomic_load_explicit(&engine.tail, memory_order_relaxed);
+    if(tail - atomic_load_explicit(&engine.head, memory_order_acquire) == ENGINE_QUEUE_SIZE) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Engine queue is full, dropping the job");
+        return 0;
+    }
+
+    EngineJob_t* job = &engine.jobs[tail & (ENGINE_QUEUE_SIZE - 1)];
+    job->type = type;
+    job->id = ++engine.last_id;
+    job->movetime = movetime;
+    if(board) CopyBoard(&job->board, board);
+
+    atomic_store_explicit(&engine.tail, tail + 1, memory_order_release);
+    SDL_SemPost(engine.pending);
+
+    return job->id;
+}
+
+bool EngineStart(void) {
+    Uint32 first = SDL_RegisterEvents(2);
+    if(first == (Uint32)-1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No SDL user events left for the engine");
+        return false;
+    }
+    EngineInfoEvent = first;
+    EngineResultEvent = first + 1;
+
+    engine.pending = SDL_CreateSemaphore(0);
+    if(!engine.pending) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_CreateSemaphore Error: %s", SDL_GetError());
+        return false;
+    }
+
+    engine.thread = SDL_CreateThread(engineMain, "engine", NULL);
+    if(!engine.thread) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_CreateThread Error: %s", SDL_GetError());
+        SDL_DestroySemaphore(engine.pending);
+        engine.pending = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void EngineShutdown(void) {
+    if(!engine.thread) return;
+
+    EngineStop();
+
+    // the stopped jobs drain quickly, wait for room for the last one
+    while(pushJob(ENGINE_JOB_QUIT, NULL, 0) == 0)
+        SDL_Delay(1);
+
+    SDL_WaitThread(engine.thread, NULL);
+    engine.thread = NULL;
+
+    SDL_DestroySemaphore(engine.pending);
+    engine.pending = NULL;
+}
+
+uint32_t EngineSearch(const Board_t* board, int64_t movetime) {
+    return pushJob(ENGINE_JOB_SEARCH, board, movetime);
+}
+
+uint32_t EnginePonder(const Board_t* board, int64_t movetime) {
+    uint32_t id = pushJob(ENGINE_JOB_PONDER, board, movetime);
+    if(id) engine.last_ponder_id = id;
+
+    return id;
+}
+
+void EnginePonderHit(void) {
+    atomic_store(&engine.ponderhit, engine.last_ponder_id);
+    atomic_store(&engine.ponder, false);
+}
+
+void EngineStop(void) {
+    atomic_store(&engine.cancelled, engine.last_id);
+    atomic_store(&engine.stop, true);
+}
+
+void EngineReleaseEvent(const SDL_Event* event) {
+    if(event->type == EngineInfoEvent || event->type == EngineResultEvent)
+        SDL_free(event->user.data1);
+}
@@ -0,0 +1,201 @@
+#include "gui.h"
+#include "setting.h"
+#include <SDL2/SDL_image.h>
+
+static SDL_Texture* textures[COLOR_IDX_COUNT][PIECE_IDX_COUNT];
+static SDL_Rect PieceSize = { .w=COL_SIZE, .h=ROW_SIZE };
+
+void InitGuiState(GuiState_t* state) {
+    state->is_highlighted = false;
+    state->highlight_area = (SDL_Rect){ .w = COL_SIZE, .h = ROW_SIZE };
+    state->legal_moves.size = 0;
+}
+
+void drawBoard(SDL_Renderer* renderer) {
+    SDL_Rect rect;
+
+    SDL_SetRenderDrawColor(renderer, 115, 149, 82, 255);
+    for(int i = 0; i < DIM_Y; i++) {
+        for(int j = (i%2==0); j < DIM_X; j+=2) {
+            rect.x = j*COL_SIZE;
+            rect.y = i*ROW_SIZE;
+
+            rect.w = COL_SIZE;
+            rect.h = ROW_SIZE;
+
+            SDL_RenderFillRect(renderer, &rect);
+        }
+    }
+
+    SDL_SetRenderDrawColor(renderer, 235, 236, 208, 255);
+    for(int i = 0; i < DIM_Y; i++) {
+        for(int j = i%2; j < DIM_X; j+=2) {
+            rect.x = j*COL_SIZE;
+            rect.y = i*ROW_SIZE;
+
+            rect.w = COL_SIZE;
+            rect.h = ROW_SIZE;
+
+            SDL_RenderFillRect(renderer, &rect);
+        }
+    }
+}
+
+void unhighlight_coord(GuiState_t* state) {
+    state->is_highlighted = false;
+}
+
+void highlight_coord(GuiState_t* state, int row, int col) {
+
+    state->is_highlighted = true;
+
+    state->highlight_area.x = col * COL_SIZE;
+    state->highlight_area.y = row * ROW_SIZE;
+
+}
+
+void drawHighlighted(SDL_Renderer* renderer, const GuiState_t* state) {
+    if(!state->is_highlighted) return;
+
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 128); // semi-transparent red
+    SDL_RenderFillRect(renderer, &state->highlight_area);
+}
+
+// load the texture from the file
+static SDL_Texture* LoadTexture(SDL_Renderer* renderer, char* filename) {
+    SDL_Surface* surface = IMG_Load(filename);
+    if(!surface) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "IMG_Load Error: %s", IMG_GetError());
+        return NULL;
+    }
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface); // No longer needed
+    if(!texture) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_CreateTextureFromSurface Error: %s", SDL_GetError());
+        return NULL;
+    }
+
+    return texture;
+}
+
+static const char* PieceTypeToString(PieceType_t type) {
+    switch(type) {
+        case PAWN:   return "Pawn";
+        case ROOK:   return "Rook";
+        case KNIGHT: return "Knight";
+        case BISHOP: return "Bishop";
+        case QUEEN:  return "Queen";
+        case KING:   return "King";
+        default:     return "None";
+    }
+}
+
+// load every piece image once, pieces on the board just index into the table
+bool loadPieceTextures(SDL_Renderer* renderer) {
+    static const PieceColor_t colors[COLOR_IDX_COUNT] = { WHITE, BLACK };
+
+    for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+        for(int p = 0; p < PIECE_IDX_COUNT; p++) {
+            if(textures[c][p]) continue;
+
+            char filename[50] = {0};
+            SDL_snprintf(filename, sizeof(filename), "%s%c%s.png", ImagesPath, colors[c], PieceTypeToString(IndexToPiece(p)));
+
+            textures[c][p] = LoadTexture(renderer, filename);
+            if(!textures[c][p]) {
+                ERROR("Failed to load texture %s.", filename);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void freePieceTextures(void) {
+    for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+        for(int p = 0; p < PIECE_IDX_COUNT; p++) {
+            if(textures[c][p]) {
+                SDL_DestroyTexture(textures[c][p]);
+                textures[c][p] = NULL; // Set to NULL after freeing
+            }
+        }
+    }
+}
+
+static void drawPiece(SDL_Renderer* renderer, Piece_t* piece) {
+    PieceSize.x = piece->x * COL_SIZE;
+    PieceSize.y = piece->y * ROW_SIZE;
+
+    SDL_Texture* texture = textures[ColorToIndex(piece->color)][PieceToIndex(piece->type)];
+    if(!texture) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Piece texture is NULL. Cannot draw piece at (%d, %d).", piece->x, piece->y);
+        return;
+    }
+
+    SDL_RenderCopy(renderer, texture, NULL, &PieceSize);
+}
+
+void drawPieces(SDL_Renderer* renderer, Board_t* board) {
+    if(!board) {
+        ERROR("Board is NULL. Cannot draw pieces.");
+        return;
+    }
+
+    for(int i = 0; i < DIM_X * DIM_Y; i++) {
+        Piece_t* piece = &board->pieces[i];
+        if(piece->type != PIECE_NONE) {
+            drawPiece(renderer, piece);
+        }
+    }
+}
+
+// highlighting only ever needs the moves of one piece, copied by value
+void set_legal_moves(GuiState_t* state, const MoveList_t* movelist) {
+    state->legal_moves.size = 0;
+    if(!movelist) {
+        return;
+    }
+
+    SDL_memcpy(state->legal_moves.moves, movelist->moves, movelist->size * sizeof(PackedMove_t));
+    state->legal_moves.size = movelist->size;
+}
+
+void clear_legal_moves(GuiState_t* state) {
+    state->legal_moves.size = 0;
+}
+
+// we'll use a circle for legal move indication (better than a square)
+static void draw_circle(SDL_Renderer* renderer, int cx, int cy, int radius) {
+    for (int w = 0; w < radius * 2; w++) {
+        for (int h = 0; h < radius * 2; h++) {
+            int dx = radius - w; // horizontal offset
+            int dy = radius - h; // vertical offset
+            if ((dx*dx + dy*dy) <= (radius * radius)) {
+                SDL_RenderDrawPoint(renderer, cx + dx, cy + dy);
+            }
+        }
+    }
+}
+
+void draw_legal_moves(SDL_Renderer* renderer, const GuiState_t* state) {
+    const MoveList_t* legal_moves = &state->legal_moves;
+    if(legal_moves->size == 0) return;
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 128); // semi-transparent green
+    int cx, cy, radius;
+
+    for(size_t i = 0; i < legal_moves->size; i++) {
+        int to = MoveTo(legal_moves->moves[i]);
+        cx = COL_OF(to) * COL_SIZE + COL_SIZE / 2;
+        cy = ROW_OF(to) * ROW_SIZE + ROW_SIZE / 2;
+
+        radius = (COL_SIZE < ROW_SIZE ? COL_SIZE : ROW_SIZE) / 6;
+
+        draw_circle(renderer, cx, cy, radius);
+        // SDL_RenderFillRect(renderer, &rect);
+    }
+}
+
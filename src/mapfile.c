@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "mapfile.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MapFile(const char* path, MappedFile_t* file, bool sequential) {
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = false;
+
+#if defined(_WIN32)
+    (void)sequential;
+
+    FILE* stream = fopen(path, "rb");
+    if(!stream) return false;
+
+    fseek(stream, 0, SEEK_END);
+    long length = ftell(stream);
+    fseek(stream, 0, SEEK_SET);
+
+    uint8_t* data = (length > 0) ? malloc((size_t)length) : NULL;
+    if(data && fread(data, 1, (size_t)length, stream) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(stream);
+    if(!data) return false;
+
+    file->data = data;
+    file->size = (size_t)length;
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file alive
+
+    if(data == MAP_FAILED) return false;
+
+    if(sequential) madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    file->data = data;
+    file->size = (size_t)st.st_size;
+    file->mapped = true;
+    return true;
+#endif
+}
+
+void UnmapFile(MappedFile_t* file) {
+    if(!file->data) return;
+
+#if !defined(_WIN32)
+    if(file->mapped)
+        munmap((void*)file->data, file->size);
+    else
+#endif
+        free((void*)file->data);
+
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = false;
+}
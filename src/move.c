@@ -1,88 +1,8 @@
 #include "move.h"
 #include "move_internal.h"
 #include "board.h"
-
-// for highlighting moves
-static MoveList_t legal_moves;
-
-// this makes life so much easier
-// #define AllocMem(size) (Move_t*)malloc(size * sizeof(Move_t));
-// #define CheckType(piece, Type, msg) if((piece)->type != Type) { \
-//     ERROR("%s", msg); \
-//     return (MoveList_t){NULL, 0}; \
-// }
-// #define Check(moves) if(!moves) { \
-//     ERROR("Memory allocation failed for moves."); \
-//     return (MoveList_t){NULL, 0}; \
-// }
-// #define ReAllocAttempt(movelist) Move_t* tmp = realloc(movelist.moves, movelist.size * sizeof(Move_t)); \
-// if(!tmp) {  /* if allocation failed then we just keep it as it is. */ \
-//     ERROR("Memory reallocation failed for moves"); \
-//     return movelist; \
-// } \
-// movelist.moves = tmp;
-
-// I'm actually abusing macros 😭🙏🏽🙏🏽🙏🏽
-
-static Move_t* copy(MoveList_t* movelist) {
-    Move_t* copy = AllocMem(movelist->size);
-    if(copy == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to allocate memory for move copy.");
-        return NULL;
-    }
-
-    SDL_memcpy(copy, movelist->moves, movelist->size * sizeof(Move_t));
-    return copy;
-}
-
-void set_legal_moves(MoveList_t movelist) {
-    if(legal_moves.size != 0 && legal_moves.moves) {
-        free(legal_moves.moves);
-        legal_moves.moves = NULL;
-        legal_moves.size = 0;
-    }
-    if(movelist.size == 0) {
-        return;
-    }
-
-    legal_moves.moves = copy(&movelist);
-    if (legal_moves.moves == NULL) {
-        legal_moves.size = 0;
-        return;
-    }
-    legal_moves.size = movelist.size;
-}
-
-// we'll use a circle for legal move indication (better than a square)
-static void draw_circle(SDL_Renderer* renderer, int cx, int cy, int radius) {
-    for (int w = 0; w < radius * 2; w++) {
-        for (int h = 0; h < radius * 2; h++) {
-            int dx = radius - w; // horizontal offset
-            int dy = radius - h; // vertical offset
-            if ((dx*dx + dy*dy) <= (radius * radius)) {
-                SDL_RenderDrawPoint(renderer, cx + dx, cy + dy);
-            }
-        }
-    }
-}
-
-void draw_legal_moves(SDL_Renderer* renderer) {
-    if(legal_moves.moves == NULL || legal_moves.size == 0) return;
-
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 128); // semi-transparent green
-    int cx, cy, radius;
-
-    for(size_t i = 0; i < legal_moves.size; i++) {
-        cx = legal_moves.moves[i].to_col * COL_SIZE + COL_SIZE / 2;
-        cy = legal_moves.moves[i].to_row * ROW_SIZE + ROW_SIZE / 2;
-
-        radius = (COL_SIZE < ROW_SIZE ? COL_SIZE : ROW_SIZE) / 6;
-
-        draw_circle(renderer, cx, cy, radius);
-        // SDL_RenderFillRect(renderer, &rect);
-    }
-}
+#include "magic.h"
+#include <string.h>
 
 void InitMoveP(Move_t* move, Piece_t* piece, int to_row, int to_col, bool promotion) {
     return InitMove(move, piece->y, piece->x, to_row, to_col, promotion);
@@ -98,367 +18,445 @@ void InitMove(Move_t* move, int from_row, int from_col, int to_row, int to_col,
     move->promotion = promotion;
 }
 
-void AddMove(MoveList_t* movelist, Move_t* moves, size_t* size) {
-    int new_size = movelist->size + *size;
-    Move_t* new_moves = AllocMem(new_size);
-    if(!new_moves) {
-        ERROR("Failed to allocate memory for AddMove");
-        return;
-    }
-    // Check(new_moves);
+void UnpackMove(PackedMove_t packed, Move_t* move) {
+    int from = MoveFrom(packed), to = MoveTo(packed);
+    InitMove(move, ROW_OF(from), COL_OF(from), ROW_OF(to), COL_OF(to), IsPromotion(packed));
+}
+
+PackedMove_t MatchMove(Board_t* board, const Move_t* move) {
+    MoveList_t movelist;
+    movelist.size = 0;
+    getLegalMoves(board, &board->pieces[SQUARE(move->from_row, move->from_col)], &movelist);
 
-    if(movelist->moves)
-        SDL_memcpy(new_moves, movelist->moves, movelist->size * sizeof(Move_t));
+    // from and to sit in the low 12 bits, so a single compare per move
+    PackedMove_t key = PackMove(SQUARE(move->from_row, move->from_col), SQUARE(move->to_row, move->to_col), 0);
 
-    for (int i = 0; i < *size; i++) {
-        new_moves[i+movelist->size] = moves[i];
-    }
+    for(size_t i = 0; i < movelist.size; i++) {
+        PackedMove_t candidate = movelist.moves[i];
+        if((candidate & 0x0FFF) != key) continue;
 
-    free(movelist->moves);
+        if(!IsPromotion(candidate) || PromotionPiece(candidate) == QUEEN)
+            return candidate;
+    }
 
-    movelist->moves = new_moves;
-    movelist->size = new_size;
+    return NO_MOVE;
 }
 
-void AddMoveM(MoveList_t* movelist, MoveList_t movelist2) {
-    AddMove(movelist, movelist2.moves, &movelist2.size);
+// coordinate notation, e.g. "e2e4" or "e7e8q"
+void MoveToString(PackedMove_t move, char buffer[6]) {
+    int from = MoveFrom(move), to = MoveTo(move);
+
+    buffer[0] = 'a' + COL_OF(from);
+    buffer[1] = '0' + (DIM_Y - ROW_OF(from));
+    buffer[2] = 'a' + COL_OF(to);
+    buffer[3] = '0' + (DIM_Y - ROW_OF(to));
+    buffer[4] = IsPromotion(move) ? PromotionPiece(move) : '\0';
+    buffer[5] = '\0';
 }
 
-MoveList_t getLegalMoves(Board_t* board, Piece_t* piece) {
-    switch(piece->type) {
-        case PAWN:
-            return PawnMoves(board, piece);
-        case ROOK:
-            return RookMoves(board, piece);
-        case KNIGHT:
-            return KnightMoves(board, piece);
-        case BISHOP:
-            return BishopMoves(board, piece);
-        case QUEEN:
-            return QueenMoves(board, piece);
-        case KING:
-            return KingMoves(board, piece);
-        default:
-            return (MoveList_t){NULL, 0};
+PackedMove_t StringToMove(Board_t* board, const char* text) {
+    MoveList_t movelist;
+    movelist.size = 0;
+    GenerateMoves(board, &movelist);
+
+    for(size_t i = 0; i < movelist.size; i++) {
+        char name[6];
+        MoveToString(movelist.moves[i], name);
+        if(strcmp(name, text) == 0) return movelist.moves[i];
     }
+
+    return NO_MOVE;
 }
 
-static inline bool WithinBounds(int row, int col) {
-    return row >= 0 && row < DIM_Y &&
-           col >= 0 && col < DIM_X;
+void AddMoveM(MoveList_t* movelist, const MoveList_t* movelist2) {
+    size_t count = movelist2->size;
+    if(movelist->size + count > MAX_MOVES) {
+        ERROR("Move list overflow, dropping %zu moves", movelist->size + count - MAX_MOVES);
+        count = MAX_MOVES - movelist->size;
+    }
+
+    memcpy(movelist->moves + movelist->size, movelist2->moves, count * sizeof(PackedMove_t));
+    movelist->size += count;
 }
 
 /*
-    making a function for Vertical, Horizontal, and Diagonal moves so I can reuse them
-    Its used by 3 pieces: Rooks, Bishops and Queens
+    Legal move generation.
+    Checkers, pinned pieces and the squares that answer a check are worked out
+    once per position (MoveMasks_t). Every generator then masks its targets with
+    them, so nothing is ever made and taken back just to test for check.
 */
+typedef struct MoveMasks {
+    int king;             // square of the side to move's king
+    Bitboard_t checkers;  // enemy pieces giving check
+    Bitboard_t pinned;    // our pieces that may only move along the line to the king
+    Bitboard_t evasion;   // where a non-king move has to land (everything when not in check)
+
+    GenType_t type;       // which part of the moves is wanted
+    Bitboard_t wanted;    // landing squares of that part for everything but pawns
+} MoveMasks_t;
+
+static void computeMasks(Board_t* board, GenType_t type, MoveMasks_t* masks) {
+    ColorIndex_t us = ColorToIndex(board->turn), them = us ^ 1;
+    const Bitboard_t* enemy = board->bitboards[them];
+
+    masks->type = type;
+    if(type == GEN_NOISY)
+        masks->wanted = board->occupancy[them];
+    else if(type == GEN_QUIET)
+        masks->wanted = ~board->occupied;
+    else
+        masks->wanted = ~(Bitboard_t)0;
+
+    masks->king = Lsb(board->bitboards[us][KING_IDX]);
+    masks->checkers = AttackersTo(board, masks->king, board->occupied) & board->occupancy[them];
+    masks->pinned = 0;
+
+    // sliders that would see the king on an empty board; one piece of ours in between is pinned
+    Bitboard_t snipers = (RookAttacks(masks->king, 0) & (enemy[ROOK_IDX] | enemy[QUEEN_IDX]))
+                       | (BishopAttacks(masks->king, 0) & (enemy[BISHOP_IDX] | enemy[QUEEN_IDX]));
+    while(snipers) {
+        Bitboard_t blockers = BetweenBB[masks->king][PopLsb(&snipers)] & board->occupied;
+        if(PopCount(blockers) == 1)
+            masks->pinned |= blockers & board->occupancy[us];
+    }
 
-// takes in Move_t* ptr assuming it has enough space
-static void generateVerticalMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
-    int col = piece->x;
-
-    for (int dir = -1; dir <= 1; dir += 2) { // dir = -1 (up), +1 (down)
-        int row = piece->y + dir;
+    if(masks->checkers == 0)
+        masks->evasion = ~(Bitboard_t)0;
+    else if(PopCount(masks->checkers) == 1)
+        masks->evasion = BetweenBB[masks->king][Lsb(masks->checkers)] | masks->checkers;
+    else
+        masks->evasion = 0; // double check, only the king can move
+}
 
-        while (WithinBounds(row, col)) {
-            Piece_t* target = getPiece(board, row, col);
+// emits one move per set bit in targets, flagging the ones that land on an enemy piece
+static void addTargets(Board_t* board, int from, Bitboard_t targets, MoveList_t* movelist) {
+    Bitboard_t enemy = board->occupancy[ColorToIndex(board->turn) ^ 1];
 
-            if (target && target->color == piece->color) {
-                break; // Blocked by same-color piece
-            }
+    while(targets) {
+        int to = PopLsb(&targets);
+        movelist->moves[movelist->size++] = PackMove(from, to, (enemy & BIT(to)) ? FLAG_CAPTURE : FLAG_QUIET);
+    }
+}
 
-            InitMoveP(&movelist->moves[movelist->size++], piece, row, col, 0);
+// one move per promotion piece, queen first since it's almost always the one played
+static void addPromotions(Board_t* board, int from, Bitboard_t targets, MoveList_t* movelist) {
+    Bitboard_t enemy = board->occupancy[ColorToIndex(board->turn) ^ 1];
 
-            if (target && target->color != piece->color) {
-                break; // Capture ends line
-            }
+    while(targets) {
+        int to = PopLsb(&targets);
+        int capture = (enemy & BIT(to)) ? FLAG_CAPTURE : 0;
 
-            row += dir;
-        }
+        for(int flag = FLAG_PROMO_QUEEN; flag >= FLAG_PROMO_KNIGHT; flag--)
+            movelist->moves[movelist->size++] = PackMove(from, to, flag | capture);
     }
 }
 
+// targets of a non-king piece once checks and pins are accounted for
+static inline Bitboard_t legalTargets(Board_t* board, int from, Bitboard_t attacks, const MoveMasks_t* masks) {
+    Bitboard_t targets = attacks & ~board->occupancy[ColorToIndex(board->turn)] & masks->evasion & masks->wanted;
 
-/*
-    MoveList_t movelist = { AllocMem(Enough_Space) };
-    generateMoves(board, piece, &movelist)
-    movelist.moves -> moves generated
-    movelist.size -> size
-*/
-// takes in Move_t* ptr assuming it has enough space
-static void generateDiagonalMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
-    int row, col;
-    int directions[4][2] = {
-        {-1, -1}, // up-left
-        {-1,  1}, // up-right
-        { 1, -1}, // down-left
-        { 1,  1}  // down-right
-    };
-
-    for (int d = 0; d < 4; ++d) {
-        int row = piece->y + directions[d][0];
-        int col = piece->x + directions[d][1];
-
-        while (WithinBounds(row, col)) {
-            Piece_t* target = getPiece(board, row, col);
-
-            if (target && target->color == piece->color) {
-                break;
-            }
-
-            InitMoveP(&movelist->moves[movelist->size++], piece, row, col, 0);
-
-            if (target && target->color != piece->color) {
-                break;
-            }
-
-            row += directions[d][0];
-            col += directions[d][1];
-        }
-    }
-}
+    if(masks->pinned & BIT(from))
+        targets &= LineBB[masks->king][from];
 
-// takes in Move_t* ptr assuming it has enough space
-static void generateHorizontalMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
-    int row = piece->y;
-    for(int dir = -1; dir <= 1; dir += 2) {
-        int col = piece->x + dir;
+    return targets;
+}
 
-        while (WithinBounds(row, col)) {
-            Piece_t* target = getPiece(board, row, col);
+// castling is emitted as a two file king move; MakeMove moves the rook
+static void generateCastling(Board_t* board, int from, const MoveMasks_t* masks, MoveList_t* movelist) {
+    PieceColor_t color = board->turn;
+    int row = (color == WHITE) ? DIM_Y - 1 : 0;
+    int king_side = (color == WHITE) ? CASTLE_WHITE_KING : CASTLE_BLACK_KING;
+    int queen_side = (color == WHITE) ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN;
 
-            if(target && target->color == piece->color) {
-                break;
-            }
+    // the king may not castle out of, through or into check
+    if(!(board->castling & (king_side | queen_side)) || from != SQUARE(row, 4) || masks->checkers) return;
 
-            InitMoveP(&movelist->moves[movelist->size++], piece, row, col, 0);
+    PieceColor_t them = (color == WHITE) ? BLACK : WHITE;
 
-            if(target && target->color != piece->color) {
-                break;
-            }
+    Bitboard_t between = BIT(SQUARE(row, 5)) | BIT(SQUARE(row, 6));
+    if((board->castling & king_side) && !(board->occupied & between) &&
+       !IsSquareAttacked(board, SQUARE(row, 5), them) && !IsSquareAttacked(board, SQUARE(row, 6), them)) {
+        movelist->moves[movelist->size++] = PackMove(from, SQUARE(row, 6), FLAG_KING_CASTLE);
+    }
 
-            col += dir;
-        }
+    between = BIT(SQUARE(row, 1)) | BIT(SQUARE(row, 2)) | BIT(SQUARE(row, 3));
+    if((board->castling & queen_side) && !(board->occupied & between) &&
+       !IsSquareAttacked(board, SQUARE(row, 3), them) && !IsSquareAttacked(board, SQUARE(row, 2), them)) {
+        movelist->moves[movelist->size++] = PackMove(from, SQUARE(row, 2), FLAG_QUEEN_CASTLE);
     }
 }
 
-MoveList_t KingMoves(Board_t* board, Piece_t* piece) {
-    CheckType(piece, KING, "Piece is not a King")
+static void generateKingMoves(Board_t* board, int from, const MoveMasks_t* masks, MoveList_t* movelist) {
+    ColorIndex_t us = ColorToIndex(board->turn);
+    Bitboard_t targets = KingAttacks[from] & ~board->occupancy[us] & masks->wanted;
+
+    // drop squares the enemy covers. the king is lifted off the board first,
+    // otherwise it would hide the squares behind it from a slider checking it
+    Bitboard_t occupied = board->occupied ^ BIT(from);
+    Bitboard_t safe = 0;
+    while(targets) {
+        int to = PopLsb(&targets);
+        if(!(AttackersTo(board, to, occupied) & board->occupancy[us ^ 1]))
+            safe |= BIT(to);
+    }
 
-    MoveList_t movelist;
-    movelist.size = 0;
+    addTargets(board, from, safe, movelist);
 
-    movelist.moves = AllocMem(MAX_MOVES_KING);
-    Check(movelist.moves);
+    if(masks->type != GEN_NOISY)
+        generateCastling(board, from, masks, movelist);
+}
 
-    int directions[8][2] = {
-        {-1, -1}, {-1, 0}, {-1, 1},
-        { 0, -1},          { 0, 1},
-        { 1, -1}, { 1, 0}, { 1, 1}
-    };
+// en passant removes two pawns from one row, which a pin mask can't describe.
+// test the resulting occupancy against the enemy sliders directly
+static bool enPassantIsLegal(Board_t* board, int from, int captured, const MoveMasks_t* masks) {
+    if(masks->checkers && !(masks->checkers & BIT(captured)) && !(masks->evasion & BIT(board->ep_square)))
+        return false;
 
-    // bool danger_map[DIM_Y][DIM_X] = {0};
-    // MoveList_t enemy_moves = getAttackMoves(board,  (piece->color == WHITE) ? BLACK : WHITE);
-    // for(int i = 0; i < enemy_moves.size; i++) {
-    //     int r = enemy_moves.moves[i].to_row;
-    //     int c = enemy_moves.moves[i].to_col;
+    const Bitboard_t* enemy = board->bitboards[ColorToIndex(board->turn) ^ 1];
+    Bitboard_t occupied = (board->occupied ^ BIT(from) ^ BIT(captured)) | BIT(board->ep_square);
 
-    //     danger_map[r][c] = true;
-    // }
+    return !(RookAttacks(masks->king, occupied) & (enemy[ROOK_IDX] | enemy[QUEEN_IDX])) &&
+           !(BishopAttacks(masks->king, occupied) & (enemy[BISHOP_IDX] | enemy[QUEEN_IDX]));
+}
 
-    // free(enemy_moves.moves);
+static void generatePawnMoves(Board_t* board, int from, const MoveMasks_t* masks, MoveList_t* movelist) {
+    ColorIndex_t us = ColorToIndex(board->turn);
+    Bitboard_t empty = ~board->occupied;
+
+    // white moves up the screen (towards bit 0), black down
+    Bitboard_t single, twice;
+    if(us == WHITE_IDX) {
+        single = (BIT(from) >> 8) & empty;
+        twice = ((single & (ROW_0_BB << 40)) >> 8) & empty; // only from the starting row
+    } else {
+        single = (BIT(from) << 8) & empty;
+        twice = ((single & (ROW_0_BB << 16)) << 8) & empty;
+    }
 
-    int row = piece->y, col = piece->x;
-    for(int i = 0; i < 8; i++) {
-        row = piece->y + directions[i][0];
-        col = piece->x + directions[i][1];
+    Bitboard_t captures = PawnAttacks[us][from] & board->occupancy[us ^ 1];
+    Bitboard_t targets = (single | twice | captures) & masks->evasion;
 
-        if(!WithinBounds(row, col)) continue;
+    if(masks->pinned & BIT(from))
+        targets &= LineBB[masks->king][from];
 
-        Piece_t* target = getPiece(board, row, col);
-        if(target && target->color == piece->color) continue;
+    // promotions count as noisy even without a capture
+    Bitboard_t last_row = ROW_0_BB | ROW_7_BB;
+    if(masks->type == GEN_NOISY)
+        targets &= captures | last_row;
+    else if(masks->type == GEN_QUIET)
+        targets &= ~captures & ~last_row;
 
-        // if(!danger_map[row][col]) {
-            InitMoveP(&movelist.moves[movelist.size++], piece, row, col, 0);
-        // }
-    }
+    addTargets(board, from, targets & ~last_row & ~twice, movelist);
+    addPromotions(board, from, targets & last_row, movelist);
 
-    if (movelist.size == 0) {
-        free(movelist.moves);
-        return (MoveList_t){NULL, 0};
-    }
+    if(targets & twice)
+        movelist->moves[movelist->size++] = PackMove(from, Lsb(twice), FLAG_DOUBLE_PUSH);
 
-    ReAllocAttempt(movelist)
+    if(masks->type != GEN_QUIET && board->ep_square != NO_SQUARE && (PawnAttacks[us][from] & BIT(board->ep_square))) {
+        int captured = board->ep_square + ((us == WHITE_IDX) ? DIM_X : -DIM_X);
 
-    return movelist;
+        if(enPassantIsLegal(board, from, captured, masks))
+            movelist->moves[movelist->size++] = PackMove(from, board->ep_square, FLAG_EN_PASSANT);
+    }
 }
 
-MoveList_t QueenMoves(Board_t* board, Piece_t* piece) {
-    CheckType(piece, QUEEN, "Piece is not a Queen")
-
-    MoveList_t movelist;
-    movelist.size = 0;
-
-    movelist.moves = AllocMem(MAX_MOVES_QUEEN);
-    Check(movelist.moves);
+static void generatePieceMoves(Board_t* board, int from, const MoveMasks_t* masks, MoveList_t* movelist) {
+    Bitboard_t attacks;
 
-    generateDiagonalMoves(board, piece, &movelist);
-    generateHorizontalMoves(board, piece, &movelist);
-    generateVerticalMoves(board, piece, &movelist);
-
-    if (movelist.size == 0) {
-        free(movelist.moves);
-        return (MoveList_t){NULL, 0};
+    switch(board->pieces[from].type) {
+        case KING:
+            generateKingMoves(board, from, masks, movelist);
+            return;
+        case PAWN:
+            generatePawnMoves(board, from, masks, movelist);
+            return;
+        case KNIGHT:
+            attacks = KnightAttacks[from];
+            break;
+        case BISHOP:
+            attacks = BishopAttacks(from, board->occupied);
+            break;
+        case ROOK:
+            attacks = RookAttacks(from, board->occupied);
+            break;
+        case QUEEN:
+            attacks = QueenAttacks(from, board->occupied);
+            break;
+        default:
+            return;
     }
 
-    ReAllocAttempt(movelist);
-
-    return movelist;
+    addTargets(board, from, legalTargets(board, from, attacks, masks), movelist);
 }
 
-MoveList_t BishopMoves(Board_t* board, Piece_t* piece) {
-    CheckType(piece, BISHOP, "Piece is not a Bishop")
+// only the side to move has legal moves
+void getLegalMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
+    if(piece->type == PIECE_NONE || piece->color != (PieceColor_t)board->turn) return;
 
-    MoveList_t movelist;
-    movelist.size = 0;
-    movelist.moves = AllocMem(MAX_MOVES_BISHOP);
+    MoveMasks_t masks;
+    computeMasks(board, GEN_ALL, &masks);
 
-    Check(movelist.moves);
+    int from = SQUARE(piece->y, piece->x);
+    if(PopCount(masks.checkers) > 1 && piece->type != KING) return;
 
-    // *size = 0;
-    // Move_t* moves = AllocMem(MAX_MOVES_BISHOP);
-    // Check(moves);
+    generatePieceMoves(board, from, &masks, movelist);
+}
 
-    generateDiagonalMoves(board, piece, &movelist);
+// moves of the pieces on the squares of from, which must all belong to the side to move
+static void generateFrom(Board_t* board, GenType_t type, Bitboard_t from, MoveList_t* movelist) {
+    MoveMasks_t masks;
+    computeMasks(board, type, &masks);
 
-    if (movelist.size == 0) {
-        free(movelist.moves);
-        return (MoveList_t){NULL, 0};
-    }
+    if(PopCount(masks.checkers) > 1)
+        from &= BIT(masks.king);
 
-    ReAllocAttempt(movelist);
+    while(from) {
+        generatePieceMoves(board, PopLsb(&from), &masks, movelist);
+    }
+}
 
-    return movelist;
+static void generateAll(Board_t* board, GenType_t type, MoveList_t* movelist) {
+    generateFrom(board, type, board->occupancy[ColorToIndex(board->turn)], movelist);
 }
 
-MoveList_t RookMoves(Board_t* board, Piece_t* piece) {
-    CheckType(piece, ROOK, "Piece is not a Rook")
+void GenerateMoves(Board_t* board, MoveList_t* movelist) {
+    generateAll(board, GEN_ALL, movelist);
+}
 
-    MoveList_t movelist;
-    movelist.size = 0;
-    movelist.moves = AllocMem(MAX_MOVES_ROOK);
-    Check(movelist.moves);
+void GenerateNoisy(Board_t* board, MoveList_t* movelist) {
+    generateAll(board, GEN_NOISY, movelist);
+}
 
-    generateVerticalMoves(board, piece, &movelist);
-    generateHorizontalMoves(board, piece, &movelist);
+void GenerateQuiets(Board_t* board, MoveList_t* movelist) {
+    generateAll(board, GEN_QUIET, movelist);
+}
 
-    if (movelist.size == 0) {
-        free(movelist.moves);
-        return (MoveList_t){NULL, 0};
+static inline bool isFile(char c) { return c >= 'a' && c < 'a' + DIM_X; }
+static inline bool isRank(char c) { return c >= '1' && c < '1' + DIM_Y; }
+
+static PieceType_t sanPiece(char c) {
+    switch(c) {
+        case 'N': return KNIGHT;
+        case 'B': return BISHOP;
+        case 'R': return ROOK;
+        case 'Q': return QUEEN;
+        case 'K': return KING;
+        default:  return PIECE_NONE;
     }
-
-    ReAllocAttempt(movelist);
-
-    return movelist;
 }
 
-MoveList_t KnightMoves(Board_t* board, Piece_t* piece) {
-    CheckType(piece, KNIGHT, "Piece is not a Knight")
+/*
+    Standard algebraic notation: Nf3, exd5, R1e2, Qh4xe1, e8=Q, O-O-O.
+    Also taken: 0-0 castling, promotions without '=' or in lower case,
+    and trailing check marks and annotations (+ # ! ?), which are not
+    checked. Only the pieces the text can refer to are generated.
+*/
+PackedMove_t SanToMove(Board_t* board, const char* text, size_t length) {
+    while(length > 0 && strchr("+#!?", text[length - 1])) length--;
+    if(length < 2) return NO_MOVE;
 
+    ColorIndex_t us = ColorToIndex(board->turn);
     MoveList_t movelist;
     movelist.size = 0;
 
-    movelist.moves = AllocMem(MAX_MOVES_KNIGHT);
-    Check(movelist.moves);
-
-    // *size = 0;
-    // Move_t* moves = AllocMem(MAX_MOVES_KNIGHT);
-    // Check(moves);
+    if(text[0] == 'O' || text[0] == '0') {
+        int flag;
+        if(length == 3 && text[1] == '-' && text[2] == text[0]) flag = FLAG_KING_CASTLE;
+        else if(length == 5 && text[1] == '-' && text[2] == text[0] && text[3] == '-' && text[4] == text[0]) flag = FLAG_QUEEN_CASTLE;
+        else return NO_MOVE;
 
-    int row = piece->y; // row is y
-    int col = piece->x; // col is x
+        generateFrom(board, GEN_QUIET, board->bitboards[us][KING_IDX], &movelist);
+        for(size_t i = 0; i < movelist.size; i++) {
+            if(MoveFlags(movelist.moves[i]) == flag) return movelist.moves[i];
+        }
 
-    int offsets[8][2] = {
-        {-2, -1}, {-2, +1},
-        {-1, -2}, {-1, +2},
-        {+1, -2}, {+1, +2},
-        {+2, -1}, {+2, +1}
-    };
+        return NO_MOVE;
+    }
 
-    for (int i = 0; i < 8; i++) {
-        int nrow = row + offsets[i][0];
-        int ncol = col + offsets[i][1];
-        if (WithinBounds(nrow, ncol)) {
-            Piece_t* target = getPiece(board, nrow, ncol);
+    PieceType_t piece = PAWN;
+    if(sanPiece(text[0]) != PIECE_NONE) {
+        piece = sanPiece(*text++);
+        length--;
+    }
 
-            if (!target || target->color != piece->color) {
-                InitMoveP(&movelist.moves[movelist.size++], piece, nrow, ncol, 0);
-            }
+    // promotion at the end: "=Q", "Q" or "=q"
+    PieceType_t promotion = PIECE_NONE;
+    if(piece == PAWN && length >= 3) {
+        char last = text[length - 1];
+        PieceType_t promoted = sanPiece((last >= 'a' && last <= 'z') ? last - 'a' + 'A' : last);
+        if(promoted != PIECE_NONE && promoted != KING && (text[length - 2] == '=' || isRank(text[length - 2]))) {
+            promotion = promoted;
+            length -= (text[length - 2] == '=') ? 2 : 1;
         }
     }
 
-    if (movelist.size == 0) {
-        free(movelist.moves);
-        return (MoveList_t){NULL, 0};
-    }
+    if(length < 2 || !isFile(text[length - 2]) || !isRank(text[length - 1])) return NO_MOVE;
+    int to = SQUARE(DIM_Y - (text[length - 1] - '0'), text[length - 2] - 'a');
+    length -= 2;
 
-    ReAllocAttempt(movelist);
+    if(length > 0 && (text[length - 1] == 'x' || text[length - 1] == ':')) length--;
 
-    return movelist;
-}
+    // what is left disambiguates: a file, a rank or both
+    if(length > 2) return NO_MOVE;
 
-MoveList_t PawnMoves(Board_t* board, Piece_t* piece) {
-    CheckType(piece, PAWN, "Piece is not a Pawn")
-
-    MoveList_t movelist;
-    movelist.size = 0;
-
-    movelist.moves = AllocMem(MAX_MOVES_PAWN);
-    Check(movelist.moves);
+    Bitboard_t from = board->bitboards[us][PieceToIndex(piece)];
+    for(size_t i = 0; i < length; i++) {
+        if(isFile(text[i])) from &= FILE_A_BB << (text[i] - 'a');
+        else if(isRank(text[i])) from &= ROW_0_BB << (DIM_X * (DIM_Y - (text[i] - '0')));
+        else return NO_MOVE;
+    }
 
-    int direction = (piece->color == WHITE) ? -1 : 1;
-    int start_row = (piece->color == WHITE) ? 6 : 1;
-    // *size = 0;
+    // pieces attack symmetrically, so only those that see the target square can move there
+    switch(piece) {
+        case KNIGHT: from &= KnightAttacks[to]; break;
+        case BISHOP: from &= BishopAttacks(to, board->occupied); break;
+        case ROOK:   from &= RookAttacks(to, board->occupied); break;
+        case QUEEN:  from &= QueenAttacks(to, board->occupied); break;
+        default: break;
+    }
+    if(from == 0) return NO_MOVE;
 
-    // Move_t* moves = AllocMem(MAX_MOVES_PAWN);
-    // Check(moves);
+    generateFrom(board, GEN_ALL, from, &movelist);
 
-    // forward
-    if(piece->y + direction >= 0 && piece->y + direction < DIM_Y &&
-        !getPiece(board, piece->y + direction, piece->x)) {
+    PackedMove_t found = NO_MOVE;
+    for(size_t i = 0; i < movelist.size; i++) {
+        PackedMove_t move = movelist.moves[i];
+        if(MoveTo(move) != to) continue;
+        if(IsPromotion(move) ? PromotionPiece(move) != promotion : promotion != PIECE_NONE) continue;
 
-        InitMoveP(&movelist.moves[movelist.size++], piece, piece->y + direction, piece->x, 0);
+        if(found != NO_MOVE) return NO_MOVE; // ambiguous
+        found = move;
+    }
 
+    return found;
+}
 
-        if(piece->y == start_row && 
-           !getPiece(board, piece->y + 2 * direction, piece->x)) {
-            InitMoveP(&movelist.moves[movelist.size++], piece, piece->y + 2 * direction, piece->x, 0);
-        }
-    }
+void KingMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
+    CheckType(piece, KING, "Piece is not a King")
+    getLegalMoves(board, piece, movelist);
+}
 
-    // Capture left
-    if(piece->x > 0 && piece->y + direction >= 0 && piece->y + direction < DIM_Y) {
-        Piece_t* target = getPiece(board, piece->y + direction, piece->x - 1);
-        if(target && target->color != piece->color) {
-            InitMoveP(&movelist.moves[movelist.size++], piece, piece->y + direction, piece->x - 1, 0);
-        }
-    }
+void QueenMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
+    CheckType(piece, QUEEN, "Piece is not a Queen")
+    getLegalMoves(board, piece, movelist);
+}
 
-    // Capture right
-    if(piece->x < DIM_X - 1 && piece->y + direction >= 0 && piece->y + direction < DIM_Y) {
-        Piece_t* target = getPiece(board, piece->y + direction, piece->x + 1);
-        if(target && target->color != piece->color) {
-            InitMoveP(&movelist.moves[movelist.size++], piece, piece->y + direction, piece->x + 1, 0);
-        }
-    }
+void BishopMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
+    CheckType(piece, BISHOP, "Piece is not a Bishop")
+    getLegalMoves(board, piece, movelist);
+}
 
-    // If no moves found, free allocated memory and return NULL
-    if(movelist.size == 0) {
-        free(movelist.moves);
-        return (MoveList_t){NULL, 0};
-    }
+void RookMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
+    CheckType(piece, ROOK, "Piece is not a Rook")
+    getLegalMoves(board, piece, movelist);
+}
 
-    ReAllocAttempt(movelist);
+void KnightMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
+    CheckType(piece, KNIGHT, "Piece is not a Knight")
+    getLegalMoves(board, piece, movelist);
+}
 
-    return movelist;
-}
\ No newline at end of file
+void PawnMoves(Board_t* board, Piece_t* piece, MoveList_t* movelist) {
+    CheckType(piece, PAWN, "Piece is not a Pawn")
+    getLegalMoves(board, piece, movelist);
+}
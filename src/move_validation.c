@@ -1,32 +1,16 @@
 #include "move.h"
 #include "move_internal.h"
 #include "board.h"
+#include "magic.h"
 
 /*
-    * here's the plan:
-    * generate every possible move after each turn.
-    * This lets us check king moves (the annoying bastard)
-    * this might be less memory efficient but
-    * we can sacrifce some memory for performance
+    * move generation is fully legal (see GenerateMoves in move.c),
+    * so validating a move is just looking it up in the piece's list.
 */
 
-// will hold current player's legal moves.
-static MoveList_t LegalMoves;
-
-static bool inline MoveEqual(Move_t* move1, Move_t* move2) {
-    return move1->from_col == move2->from_col &&
-           move1->from_row == move2->from_row &&
-           move1->to_col == move2->to_col &&
-           move1->to_row == move2->to_row;
-}
-
-static bool IsInMoves(Move_t* move, MoveList_t moves) {
-    if(!move || !moves.moves) return false;
-    
-    for(int i = 0; i < moves.size; i++) {
-        Move_t* n_move = moves.moves + i;
-
-        if(MoveEqual(move, n_move)) {
+static bool IsInMoves(PackedMove_t move, const MoveList_t* moves) {
+    for(size_t i = 0; i < moves->size; i++) {
+        if(moves->moves[i] == move) {
             return true;
         }
     }
@@ -34,99 +18,65 @@ static bool IsInMoves(Move_t* move, MoveList_t moves) {
     return false;
 }
 
-static MoveList_t getPawnAttackMoves(Board_t* board, Piece_t* piece) {
-    MoveList_t movelist;
-    movelist.size = 0;
-
-    movelist.moves = AllocMem(MAX_MOVES_PAWN);
-    Check(movelist.moves);
-
-    int direction = (piece->color == WHITE) ? -1 : 1;
-    
-    // Capture left
-    if(piece->x > 0 && piece->y + direction >= 0 && piece->y + direction < DIM_Y) {
-            InitMoveP(&movelist.moves[movelist.size++], piece, piece->y + direction, piece->x - 1, 0);
-    }
-
-    // Capture right
-    if(piece->x < DIM_X - 1 && piece->y + direction >= 0 && piece->y + direction < DIM_Y) {
-            InitMoveP(&movelist.moves[movelist.size++], piece, piece->y + direction, piece->x + 1, 0);
-    }
-
-    if (movelist.size == 0) {
-        free(movelist.moves);
-        return (MoveList_t){NULL, 0};
-    }
-
-    return movelist;
+// every piece of either color attacking square, with blockers given by occupied
+Bitboard_t AttackersTo(const Board_t* board, int square, Bitboard_t occupied) {
+    const Bitboard_t (*bb)[PIECE_IDX_COUNT] = board->bitboards;
+
+    Bitboard_t diagonal = bb[WHITE_IDX][BISHOP_IDX] | bb[WHITE_IDX][QUEEN_IDX] |
+                          bb[BLACK_IDX][BISHOP_IDX] | bb[BLACK_IDX][QUEEN_IDX];
+    Bitboard_t straight = bb[WHITE_IDX][ROOK_IDX] | bb[WHITE_IDX][QUEEN_IDX] |
+                          bb[BLACK_IDX][ROOK_IDX] | bb[BLACK_IDX][QUEEN_IDX];
+
+    // a pawn on square capturing like a black pawn hits the white pawns attacking it
+    return (PawnAttacks[BLACK_IDX][square] & bb[WHITE_IDX][PAWN_IDX])
+         | (PawnAttacks[WHITE_IDX][square] & bb[BLACK_IDX][PAWN_IDX])
+         | (KnightAttacks[square] & (bb[WHITE_IDX][KNIGHT_IDX] | bb[BLACK_IDX][KNIGHT_IDX]))
+         | (KingAttacks[square] & (bb[WHITE_IDX][KING_IDX] | bb[BLACK_IDX][KING_IDX]))
+         | (BishopAttacks(square, occupied) & diagonal)
+         | (RookAttacks(square, occupied) & straight);
 }
 
-MoveList_t getAttackMoves(Board_t* board, PieceColor_t color) {
-    MoveList_t finalMoves = {NULL, 0};
+// looks outward from square, cheapest pieces first, and stops at the first hit
+bool IsSquareAttacked(const Board_t* board, int square, PieceColor_t by) {
+    ColorIndex_t c = ColorToIndex(by);
+    const Bitboard_t* bb = board->bitboards[c];
 
-    for(int row = 0; row < DIM_Y; row++) {
-        for(int col = 0; col < DIM_X; col++) {
-            Piece_t* target = getPiece(board, row, col);
+    if(PawnAttacks[c ^ 1][square] & bb[PAWN_IDX]) return true;
+    if(KnightAttacks[square] & bb[KNIGHT_IDX]) return true;
+    if(KingAttacks[square] & bb[KING_IDX]) return true;
+    if(BishopAttacks(square, board->occupied) & (bb[BISHOP_IDX] | bb[QUEEN_IDX])) return true;
+    if(RookAttacks(square, board->occupied) & (bb[ROOK_IDX] | bb[QUEEN_IDX])) return true;
 
-            // refuse if: empty square, wrong color, or its a king
-            if(!target || target->color != color || target->type == KING)
-                //TODO: Add pawn attack moves later
-                continue;
-            
-            MoveList_t moves;
-
-            if(target->type == PAWN)
-                moves = getPawnAttackMoves(board, target);
-            else
-                moves = getLegalMoves(board, target);
-
-            AddMoveM(&finalMoves, moves);
-
-            free(moves.moves);
-        }
-    }
-
-    return finalMoves;
+    return false;
 }
 
 bool IsCheck(Board_t* board, PieceColor_t color) {
-    if(!board->WhiteKing || !board->BlackKing) {
-        ERROR("Both Kings aren't present!");
+    Bitboard_t king = board->bitboards[ColorToIndex(color)][KING_IDX];
+    if(!king) {
+        ERROR("King is missing!");
         return false;
     }
 
-    MoveList_t enemy_attacks = getAttackMoves(board,
-                            (color == WHITE) ?BLACK : WHITE);
-
-    Piece_t* king = (color == WHITE) ? board->WhiteKing : board->BlackKing;
-    // LOG("King Coords: (%dx%d)", king->y, king->x);
-    for (int i = 0; i < enemy_attacks.size; i++) {
-        int r = enemy_attacks.moves[i].to_row;
-        int c = enemy_attacks.moves[i].to_col;
-
-        // LOG("Checking %dx%d", r, c);
-        if (r == king->y && c == king->x) {
-            free(enemy_attacks.moves);
-            return true; // King is attacked
-        }
-    }
-
-    free(enemy_attacks.moves);
-    return false; // King is safe
+    return IsSquareAttacked(board, Lsb(king), (color == WHITE) ? BLACK : WHITE);
 }
 
 // checks if a move is valid.
 // this should only take a single move
 bool isValidMove(Board_t* board, Piece_t* piece, Move_t* move) {
- 
-     MoveList_t moves = getLegalMoves(board, piece);
-    
-    bool result = IsInMoves(move, moves);
-    
-    // Free allocated memory
-    if(moves.moves) {
-        free(moves.moves);
+    if(SQUARE(move->from_row, move->from_col) != SQUARE(piece->y, piece->x)) {
+        return false;
     }
-    
-    return result;
- }
+
+    return MatchMove(board, move) != NO_MOVE;
+}
+
+// for moves that didn't come from this position's generator (hash moves, killers)
+bool IsLegalMove(Board_t* board, PackedMove_t move) {
+    if(move == NO_MOVE) return false;
+
+    MoveList_t moves;
+    moves.size = 0;
+    getLegalMoves(board, &board->pieces[MoveFrom(move)], &moves);
+
+    return IsInMoves(move, &moves);
+}
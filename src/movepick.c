@@ -0,0 +1,157 @@
+#include "movepick.h"
+#include "evaluate.h"
+#include "see.h"
+
+void InitMovePicker(MovePicker_t* picker, Board_t* board, PackedMove_t hash_move,
+                    const PackedMove_t killers[2], const History_t* history) {
+    picker->board = board;
+    picker->stage = STAGE_HASH;
+    picker->hash_move = hash_move;
+    picker->killers[0] = killers ? killers[0] : NO_MOVE;
+    picker->killers[1] = killers ? killers[1] : NO_MOVE;
+    picker->history = history;
+    picker->noisy_only = false;
+    picker->list.size = 0;
+    picker->index = 0;
+    picker->bad_noisy.size = 0;
+    picker->bad_index = 0;
+}
+
+void InitQuiescencePicker(MovePicker_t* picker, Board_t* board, PackedMove_t hash_move) {
+    if(!IsCapture(hash_move) && !IsPromotion(hash_move))
+        hash_move = NO_MOVE;
+
+    InitMovePicker(picker, board, hash_move, NULL, NULL);
+    picker->noisy_only = true;
+}
+
+// victim first, attacker as the tie break. promotions add the new piece
+static int scoreNoisy(const Board_t* board, PackedMove_t move) {
+    int score = 0;
+
+    if(MoveFlags(move) == FLAG_EN_PASSANT)
+        score += PieceValues[PAWN_IDX] * 8;
+    else if(IsCapture(move))
+        score += PieceValues[PieceToIndex(board->pieces[MoveTo(move)].type)] * 8;
+
+    if(IsPromotion(move))
+        score += PieceValues[PieceToIndex(PromotionPiece(move))] * 8;
+
+    return score - PieceToIndex(board->pieces[MoveFrom(move)].type);
+}
+
+static void scoreMoves(MovePicker_t* picker, bool noisy) {
+    for(size_t i = 0; i < picker->list.size; i++) {
+        PackedMove_t move = picker->list.moves[i];
+
+        if(noisy)
+            picker->scores[i] = scoreNoisy(picker->board, move);
+        else
+            picker->scores[i] = picker->history ? (*picker->history)[MoveFrom(move)][MoveTo(move)] : 0;
+    }
+}
+
+// selection sort one step at a time: after a cutoff the rest is never sorted
+static PackedMove_t pickBest(MovePicker_t* picker) {
+    size_t best = picker->index;
+
+    for(size_t i = picker->index + 1; i < picker->list.size; i++) {
+        if(picker->scores[i] > picker->scores[best])
+            best = i;
+    }
+
+    PackedMove_t move = picker->list.moves[best];
+    int score = picker->scores[best];
+
+    picker->list.moves[best] = picker->list.moves[picker->index];
+    picker->scores[best] = picker->scores[picker->index];
+    picker->list.moves[picker->index] = move;
+    picker->scores[picker->index] = score;
+
+    picker->index++;
+    return move;
+}
+
+static bool isKiller(const MovePicker_t* picker, PackedMove_t move) {
+    return move == picker->killers[0] || move == picker->killers[1];
+}
+
+PackedMove_t NextMove(MovePicker_t* picker) {
+    PackedMove_t move;
+
+    switch(picker->stage) {
+        case STAGE_HASH:
+            picker->stage = STAGE_NOISY_INIT;
+            if(IsLegalMove(picker->board, picker->hash_move))
+                return picker->hash_move;
+            picker->hash_move = NO_MOVE;
+            // fall through
+
+        case STAGE_NOISY_INIT:
+            picker->list.size = 0;
+            picker->index = 0;
+            GenerateNoisy(picker->board, &picker->list);
+            scoreMoves(picker, true);
+            picker->stage = STAGE_NOISY;
+            // fall through
+
+        case STAGE_NOISY:
+            while(picker->index < picker->list.size) {
+                move = pickBest(picker);
+                if(move == picker->hash_move) continue;
+
+                // captures that lose material wait until after the quiet moves
+                if(!picker->noisy_only && !SeeGE(picker->board, move, 0)) {
+                    picker->bad_noisy.moves[picker->bad_noisy.size++] = move;
+                    continue;
+                }
+
+                return move;
+            }
+            picker->stage = picker->noisy_only ? STAGE_DONE : STAGE_KILLER_1;
+            if(picker->noisy_only) return NO_MOVE;
+            // fall through
+
+        // a killer is a quiet move here only if the generator would emit it with the same flags
+        case STAGE_KILLER_1:
+            picker->stage = STAGE_KILLER_2;
+            move = picker->killers[0];
+            if(move != picker->hash_move && !IsCapture(move) && !IsPromotion(move) && IsLegalMove(picker->board, move))
+                return move;
+            // fall through
+
+        case STAGE_KILLER_2:
+            picker->stage = STAGE_QUIET_INIT;
+            move = picker->killers[1];
+            if(move != picker->hash_move && move != picker->killers[0] && !IsCapture(move) && !IsPromotion(move)
+               && IsLegalMove(picker->board, move))
+                return move;
+            // fall through
+
+        case STAGE_QUIET_INIT:
+            picker->list.size = 0;
+            picker->index = 0;
+            GenerateQuiets(picker->board, &picker->list);
+            scoreMoves(picker, false);
+            picker->stage = STAGE_QUIET;
+            // fall through
+
+        case STAGE_QUIET:
+            while(picker->index < picker->list.size) {
+                move = pickBest(picker);
+                if(move != picker->hash_move && !isKiller(picker, move)) return move;
+            }
+            picker->stage = STAGE_BAD_NOISY;
+            // fall through
+
+        case STAGE_BAD_NOISY:
+            if(picker->bad_index < picker->bad_noisy.size)
+                return picker->bad_noisy.moves[picker->bad_index++];
+            picker->stage = STAGE_DONE;
+            // fall through
+
+        case STAGE_DONE:
+        default:
+            return NO_MOVE;
+    }
+}
@@ -0,0 +1,323 @@
+#include <stdlib.h>
+#include <string.h>
+#include "nnue.h"
+#include "mapfile.h"
+
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define NNUE_X86
+#include <immintrin.h>
+#endif
+
+#define SECTION_ALIGN 64
+#define ALIGN_UP(n) (((n) + SECTION_ALIGN - 1) & ~(size_t)(SECTION_ALIGN - 1))
+
+#define BIAS_OFFSET    ALIGN_UP(sizeof(NnueHeader_t))
+#define WEIGHTS_OFFSET ALIGN_UP(BIAS_OFFSET + NNUE_HIDDEN * sizeof(int16_t))
+#define OUTPUT_OFFSET  ALIGN_UP(WEIGHTS_OFFSET + (size_t)NNUE_INPUTS * NNUE_HIDDEN * sizeof(int16_t))
+#define FILE_SIZE      (OUTPUT_OFFSET + 2 * NNUE_HIDDEN * sizeof(int8_t))
+
+_Static_assert(sizeof(NnueHeader_t) == 64, "the header is one section");
+
+// most rows a refresh adds: every piece on the board
+#define MAX_ROWS 32
+
+typedef void (*ApplyKernel_t)(int16_t* dst, const int16_t* src,
+                              const int16_t* const* adds, int add_count,
+                              const int16_t* const* subs, int sub_count);
+typedef int32_t (*OutputKernel_t)(const int16_t* us, const int16_t* them, const int8_t* weights);
+
+static struct {
+    MappedFile_t file;
+
+    const int16_t* bias;
+    const int16_t* weights;
+    const int8_t* output;
+    int32_t output_bias;
+    int32_t scale;
+
+    NnueKernel_t kernel;
+    ApplyKernel_t apply;
+    OutputKernel_t evaluate;
+} net;
+
+/* scalar kernels, the reference the SIMD ones must match */
+
+static void applyScalar(int16_t* dst, const int16_t* src,
+                        const int16_t* const* adds, int add_count,
+                        const int16_t* const* subs, int sub_count) {
+    for(int i = 0; i < NNUE_HIDDEN; i++) {
+        int value = src[i];
+
+        for(int a = 0; a < add_count; a++) value += adds[a][i];
+        for(int s = 0; s < sub_count; s++) value -= subs[s][i];
+
+        dst[i] = (int16_t)value;
+    }
+}
+
+static int32_t outputScalar(const int16_t* us, const int16_t* them, const int8_t* weights) {
+    int32_t sum = 0;
+
+    for(int half = 0; half < 2; half++) {
+        const int16_t* acc = half ? them : us;
+        const int8_t* w = weights + half * NNUE_HIDDEN;
+
+        for(int i = 0; i < NNUE_HIDDEN; i++) {
+            int value = acc[i] < 0 ? 0 : (acc[i] > NNUE_QA ? NNUE_QA : acc[i]);
+            sum += value * w[i];
+        }
+    }
+
+    return sum;
+}
+
+#if defined(NNUE_X86)
+
+/*
+    Activations are clamped to [0, 127] in int16 lanes and the int8 output
+    weights are sign extended to int16 (pmovsxbw, the SSE4.1 part), so
+    pmaddwd can multiply and pair-sum them into int32 without saturating.
+*/
+
+__attribute__((target("sse4.1")))
+static void applySse41(int16_t* dst, const int16_t* src,
+                       const int16_t* const* adds, int add_count,
+                       const int16_t* const* subs, int sub_count) {
+    for(int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i value = _mm_loadu_si128((const __m128i*)(src + i));
+
+        for(int a = 0; a < add_count; a++)
+            value = _mm_add_epi16(value, _mm_loadu_si128((const __m128i*)(adds[a] + i)));
+        for(int s = 0; s < sub_count; s++)
+            value = _mm_sub_epi16(value, _mm_loadu_si128((const __m128i*)(subs[s] + i)));
+
+        _mm_storeu_si128((__m128i*)(dst + i), value);
+    }
+}
+
+__attribute__((target("sse4.1")))
+static int32_t outputSse41(const int16_t* us, const int16_t* them, const int8_t* weights) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa = _mm_set1_epi16(NNUE_QA);
+    __m128i sum = zero;
+
+    for(int half = 0; half < 2; half++) {
+        const int16_t* acc = half ? them : us;
+        const int8_t* w = weights + half * NNUE_HIDDEN;
+
+        for(int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i value = _mm_loadu_si128((const __m128i*)(acc + i));
+            value = _mm_min_epi16(_mm_max_epi16(value, zero), qa);
+
+            __m128i weight = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)(w + i)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(value, weight));
+        }
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+static void applyAvx2(int16_t* dst, const int16_t* src,
+                      const int16_t* const* adds, int add_count,
+                      const int16_t* const* subs, int sub_count) {
+    for(int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i value = _mm256_loadu_si256((const __m256i*)(src + i));
+
+        for(int a = 0; a < add_count; a++)
+            value = _mm256_add_epi16(value, _mm256_loadu_si256((const __m256i*)(adds[a] + i)));
+        for(int s = 0; s < sub_count; s++)
+            value = _mm256_sub_epi16(value, _mm256_loadu_si256((const __m256i*)(subs[s] + i)));
+
+        _mm256_storeu_si256((__m256i*)(dst + i), value);
+    }
+}
+
+__attribute__((target("avx2")))
+static int32_t outputAvx2(const int16_t* us, const int16_t* them, const int8_t* weights) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa = _mm256_set1_epi16(NNUE_QA);
+    __m256i sum = zero;
+
+    for(int half = 0; half < 2; half++) {
+        const int16_t* acc = half ? them : us;
+        const int8_t* w = weights + half * NNUE_HIDDEN;
+
+        for(int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i value = _mm256_loadu_si256((const __m256i*)(acc + i));
+            value = _mm256_min_epi16(_mm256_max_epi16(value, zero), qa);
+
+            __m256i weight = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(w + i)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(value, weight));
+        }
+    }
+
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+    return _mm_cvtsi128_si32(total);
+}
+
+#endif // NNUE_X86
+
+static bool cpuSupports(NnueKernel_t kernel) {
+    switch(kernel) {
+        case NNUE_KERNEL_SCALAR:
+            return true;
+#if defined(NNUE_X86)
+        case NNUE_KERNEL_SSE41:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.1");
+        case NNUE_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+bool NnueSelectKernel(NnueKernel_t kernel) {
+    if(!cpuSupports(kernel)) return false;
+
+    switch(kernel) {
+#if defined(NNUE_X86)
+        case NNUE_KERNEL_AVX2:
+            net.apply = applyAvx2;
+            net.evaluate = outputAvx2;
+            break;
+        case NNUE_KERNEL_SSE41:
+            net.apply = applySse41;
+            net.evaluate = outputSse41;
+            break;
+#endif
+        default:
+            net.apply = applyScalar;
+            net.evaluate = outputScalar;
+            break;
+    }
+
+    net.kernel = kernel;
+    return true;
+}
+
+NnueKernel_t NnueCurrentKernel(void) {
+    return net.kernel;
+}
+
+const char* NnueKernelName(NnueKernel_t kernel) {
+    static const char* names[NNUE_KERNEL_COUNT] = { "scalar", "sse4.1", "avx2" };
+    return (kernel < NNUE_KERNEL_COUNT) ? names[kernel] : "unknown";
+}
+
+bool NnueLoad(const char* path) {
+    MappedFile_t file;
+    if(!MapFile(path, &file, false)) {
+        ERROR("Failed to open network file %s", path);
+        return false;
+    }
+
+    const uint8_t* data = file.data;
+    const NnueHeader_t* header = (const NnueHeader_t*)data;
+
+    if(file.size < FILE_SIZE || memcmp(header->magic, NNUE_MAGIC, sizeof(header->magic)) != 0
+        || header->version != NNUE_VERSION || header->inputs != NNUE_INPUTS
+        || header->hidden != NNUE_HIDDEN || header->scale <= 0) {
+        ERROR("%s is not a %d-%d network of version %d", path, NNUE_INPUTS, NNUE_HIDDEN, NNUE_VERSION);
+        UnmapFile(&file);
+        return false;
+    }
+
+    NnueUnload();
+
+    net.file = file;
+    net.bias = (const int16_t*)(data + BIAS_OFFSET);
+    net.weights = (const int16_t*)(data + WEIGHTS_OFFSET);
+    net.output = (const int8_t*)(data + OUTPUT_OFFSET);
+    net.output_bias = header->output_bias;
+    net.scale = header->scale;
+
+    if(!NnueSelectKernel(NNUE_KERNEL_AVX2) && !NnueSelectKernel(NNUE_KERNEL_SSE41))
+        NnueSelectKernel(NNUE_KERNEL_SCALAR);
+
+    return true;
+}
+
+void NnueUnload(void) {
+    UnmapFile(&net.file);
+
+    net.bias = NULL;
+    net.weights = NULL;
+    net.output = NULL;
+}
+
+bool NnueLoaded(void) {
+    return net.file.data != NULL;
+}
+
+// row of the input (color, piece, sq) as seen from perspective
+static inline const int16_t* featureRow(ColorIndex_t perspective, ColorIndex_t color, PieceIndex_t piece, int sq) {
+    int relative = (perspective == WHITE_IDX) ? sq : sq ^ 56; // black sees the board flipped
+    int index = ((color == perspective) ? 0 : PIECE_IDX_COUNT * SQUARE_COUNT) + piece * SQUARE_COUNT + relative;
+
+    return net.weights + (size_t)index * NNUE_HIDDEN;
+}
+
+void NnueRefresh(Accumulator_t* acc, const Board_t* board) {
+    for(int perspective = 0; perspective < COLOR_IDX_COUNT; perspective++) {
+        const int16_t* rows[MAX_ROWS];
+        int count = 0;
+
+        for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+            for(int p = 0; p < PIECE_IDX_COUNT; p++) {
+                Bitboard_t bb = board->bitboards[c][p];
+
+                while(bb && count < MAX_ROWS)
+                    rows[count++] = featureRow(perspective, c, p, PopLsb(&bb));
+            }
+        }
+
+        net.apply(acc->values[perspective], net.bias, rows, count, NULL, 0);
+    }
+}
+
+void NnueUpdate(Accumulator_t* acc, const Accumulator_t* prev, const UndoInfo_t* undo) {
+    PackedMove_t move = undo->move;
+    int from = MoveFrom(move), to = MoveTo(move), flags = MoveFlags(move);
+
+    ColorIndex_t us = ColorToIndex(undo->moved.color);
+    PieceIndex_t moved = PieceToIndex(undo->moved.type);
+    PieceIndex_t placed = IsPromotion(move) ? PieceToIndex(PromotionPiece(move)) : moved;
+
+    for(int perspective = 0; perspective < COLOR_IDX_COUNT; perspective++) {
+        const int16_t* adds[2];
+        const int16_t* subs[2];
+        int add_count = 0, sub_count = 0;
+
+        subs[sub_count++] = featureRow(perspective, us, moved, from);
+        adds[add_count++] = featureRow(perspective, us, placed, to);
+
+        if(undo->captured.type != PIECE_NONE)
+            subs[sub_count++] = featureRow(perspective, us ^ 1, PieceToIndex(undo->captured.type), undo->captured_square);
+
+        if(flags == FLAG_KING_CASTLE) {
+            subs[sub_count++] = featureRow(perspective, us, ROOK_IDX, SQUARE(ROW_OF(from), DIM_X - 1));
+            adds[add_count++] = featureRow(perspective, us, ROOK_IDX, SQUARE(ROW_OF(from), COL_OF(to) - 1));
+        } else if(flags == FLAG_QUEEN_CASTLE) {
+            subs[sub_count++] = featureRow(perspective, us, ROOK_IDX, SQUARE(ROW_OF(from), 0));
+            adds[add_count++] = featureRow(perspective, us, ROOK_IDX, SQUARE(ROW_OF(from), COL_OF(to) + 1));
+        }
+
+        net.apply(acc->values[perspective], prev->values[perspective], adds, add_count, subs, sub_count);
+    }
+}
+
+int NnueEvaluate(const Accumulator_t* acc, PieceColor_t side) {
+    ColorIndex_t us = ColorToIndex(side);
+
+    int64_t output = (int64_t)net.evaluate(acc->values[us], acc->values[us ^ 1], net.output) + net.output_bias;
+    return (int)(output * net.scale / (NNUE_QA * NNUE_QB));
+}
@@ -0,0 +1,158 @@
+#include <string.h>
+#include "packed.h"
+#include "fen.h"
+
+#define MAX_PACKED_PIECES 32
+
+bool PackPosition(const FenPosition_t* position, PackedPosition_t* packed) {
+    memset(packed, 0, sizeof(*packed));
+    if(ValidatePosition(position) != FEN_OK) return false;
+
+    int count = 0;
+    for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+        uint8_t code = position->squares[sq];
+        if(code == FEN_EMPTY) continue;
+        if(count == MAX_PACKED_PIECES) return false;
+
+        packed->occupancy |= BIT(sq);
+        packed->pieces[count / 2] |= (uint8_t)(code << (4 * (count & 1)));
+        count++;
+    }
+
+    packed->flags = (uint8_t)((position->turn == BLACK ? PACKED_BLACK_TO_MOVE : 0) | (position->castling << PACKED_CASTLING_SHIFT));
+    packed->ep_square = (position->ep_square == NO_SQUARE) ? PACKED_NO_EP : (uint8_t)position->ep_square;
+    packed->halfmove = position->halfmove;
+    packed->fullmove = position->fullmove;
+    return true;
+}
+
+bool PackBoard(const Board_t* board, PackedPosition_t* packed) {
+    memset(packed, 0, sizeof(*packed));
+
+    Bitboard_t occupied = board->occupied;
+    if(PopCount(occupied) > MAX_PACKED_PIECES) return false;
+    packed->occupancy = occupied;
+
+    for(int count = 0; occupied; count++) {
+        const Piece_t* piece = &board->pieces[PopLsb(&occupied)];
+        uint8_t code = FEN_PIECE(ColorToIndex(piece->color), PieceToIndex(piece->type));
+        packed->pieces[count / 2] |= (uint8_t)(code << (4 * (count & 1)));
+    }
+
+    packed->flags = (uint8_t)((board->turn == BLACK ? PACKED_BLACK_TO_MOVE : 0) | (board->castling << PACKED_CASTLING_SHIFT));
+    packed->ep_square = (board->ep_square == NO_SQUARE) ? PACKED_NO_EP : (uint8_t)board->ep_square;
+    packed->halfmove = (uint16_t)(board->halfmove < UINT16_MAX ? board->halfmove : UINT16_MAX);
+    packed->fullmove = (uint16_t)(board->fullmove < UINT16_MAX ? board->fullmove : UINT16_MAX);
+    return true;
+}
+
+bool UnpackPosition(const PackedPosition_t* packed, FenPosition_t* position) {
+    int count = PopCount(packed->occupancy);
+    if(count > MAX_PACKED_PIECES) return false;
+    if(packed->flags >> (PACKED_CASTLING_SHIFT + 4)) return false;
+    if(packed->ep_square != PACKED_NO_EP && packed->ep_square >= SQUARE_COUNT) return false;
+
+    // the nibbles past the last piece are zero
+    if((count & 1) && (packed->pieces[count / 2] >> 4)) return false;
+    for(int i = (count + 1) / 2; i < MAX_PACKED_PIECES / 2; i++) {
+        if(packed->pieces[i]) return false;
+    }
+
+    memset(position->squares, FEN_EMPTY, sizeof(position->squares));
+
+    Bitboard_t occupancy = packed->occupancy;
+    for(int i = 0; i < count; i++) {
+        uint8_t code = (packed->pieces[i / 2] >> (4 * (i & 1))) & 0xF;
+        if(code == FEN_EMPTY || code > FEN_PIECE(BLACK_IDX, KING_IDX)) return false;
+
+        position->squares[PopLsb(&occupancy)] = code;
+    }
+
+    position->turn = (packed->flags & PACKED_BLACK_TO_MOVE) ? BLACK : WHITE;
+    position->castling = (uint8_t)(packed->flags >> PACKED_CASTLING_SHIFT);
+    position->ep_square = (packed->ep_square == PACKED_NO_EP) ? NO_SQUARE : (int8_t)packed->ep_square;
+    position->halfmove = packed->halfmove;
+    position->fullmove = packed->fullmove;
+
+    // the same rules ParseFen keeps, so an unpacked position is always one the board can take
+    return ValidatePosition(position) == FEN_OK;
+}
+
+bool UnpackBoard(const PackedPosition_t* packed, Board_t* board) {
+    FenPosition_t position;
+    if(!UnpackPosition(packed, &position)) return false;
+
+    InitBoardFromPosition(board, &position);
+    return true;
+}
+
+bool OpenPackedFile(const char* path, PackedFile_t* file) {
+    file->records = NULL;
+    file->count = 0;
+
+    if(!MapFile(path, &file->file, false)) {
+        ERROR("Failed to open position file %s", path);
+        return false;
+    }
+
+    const PackedHeader_t* header = (const PackedHeader_t*)file->file.data;
+    size_t size = file->file.size;
+
+    if(size < sizeof(PackedHeader_t) || memcmp(header->magic, PACKED_MAGIC, sizeof(header->magic)) != 0
+        || header->version != PACKED_VERSION || header->record_size != sizeof(PackedPosition_t)
+        || (size - sizeof(PackedHeader_t)) % sizeof(PackedPosition_t) != 0) {
+        ERROR("%s is not a position file of version %d", path, PACKED_VERSION);
+        UnmapFile(&file->file);
+        return false;
+    }
+
+    file->records = (const PackedPosition_t*)(file->file.data + sizeof(PackedHeader_t));
+    file->count = (size - sizeof(PackedHeader_t)) / sizeof(PackedPosition_t);
+    return true;
+}
+
+void ClosePackedFile(PackedFile_t* file) {
+    UnmapFile(&file->file);
+    file->records = NULL;
+    file->count = 0;
+}
+
+bool CreatePackedFile(const char* path, PackedWriter_t* writer) {
+    writer->count = 0;
+    writer->file = fopen(path, "wb");
+    if(!writer->file) {
+        ERROR("Failed to create position file %s", path);
+        return false;
+    }
+
+    PackedHeader_t header = { .version = PACKED_VERSION, .record_size = sizeof(PackedPosition_t) };
+    memcpy(header.magic, PACKED_MAGIC, sizeof(header.magic));
+
+    if(fwrite(&header, sizeof(header), 1, writer->file) != 1) {
+        ERROR("Failed to write to %s", path);
+        fclose(writer->file);
+        writer->file = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+bool WritePacked(PackedWriter_t* writer, const PackedPosition_t* records, size_t count) {
+    if(!writer->file) return false;
+    if(fwrite(records, sizeof(PackedPosition_t), count, writer->file) != count) return false;
+
+    writer->count += count;
+    return true;
+}
+
+bool ClosePackedWriter(PackedWriter_t* writer) {
+    if(!writer->file) return false;
+
+    bool ok = !ferror(writer->file);
+    ok = (fclose(writer->file) == 0) && ok;
+    writer->file = NULL;
+
+    if(!ok) ERROR("Failed to write the position file");
+    return ok;
+}
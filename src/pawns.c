@@ -0,0 +1,153 @@
+#include <string.h>
+#include "pawns.h"
+
+// indexed by rank counted from the pawn's own side, 1 is the starting rank
+static const int passed_mg[DIM_Y] = { 0, 5, 10, 15, 25, 45, 70, 0 };
+static const int passed_eg[DIM_Y] = { 0, 10, 20, 35, 60, 100, 150, 0 };
+
+#define ISOLATED_MG -5
+#define ISOLATED_EG -15
+#define DOUBLED_MG  -10 // for every pawn with another of its color in front
+#define DOUBLED_EG  -20
+#define BACKWARD_MG -8
+#define BACKWARD_EG -10
+
+// per file next to or in front of the king
+#define SHIELD_CLOSE    12 // pawn still on its starting rank
+#define SHIELD_FAR       6 // pawn one step forward
+#define SHIELD_MISSING -12
+
+static Bitboard_t adjacent_files[DIM_X];
+static Bitboard_t forward_file[COLOR_IDX_COUNT][SQUARE_COUNT];  // same file, in front
+static Bitboard_t passed_span[COLOR_IDX_COUNT][SQUARE_COUNT];   // same and adjacent files, in front
+static Bitboard_t support_span[COLOR_IDX_COUNT][SQUARE_COUNT];  // adjacent files, level or behind
+
+static bool initialized = false;
+
+// white moves towards row 0, so "in front" is the rows above for white and below for black
+static Bitboard_t rowsInFront(ColorIndex_t c, int row) {
+    if(c == WHITE_IDX) return row == 0 ? 0 : (1ULL << (DIM_X * row)) - 1;
+    return row == DIM_Y - 1 ? 0 : ~((1ULL << (DIM_X * (row + 1))) - 1);
+}
+
+static int relativeRank(ColorIndex_t c, int sq) {
+    return (c == WHITE_IDX) ? DIM_Y - 1 - ROW_OF(sq) : ROW_OF(sq);
+}
+
+void InitPawns(void) {
+    if(initialized) return;
+
+    for(int col = 0; col < DIM_X; col++) {
+        adjacent_files[col] = 0;
+        if(col > 0) adjacent_files[col] |= FILE_A_BB << (col - 1);
+        if(col < DIM_X - 1) adjacent_files[col] |= FILE_A_BB << (col + 1);
+    }
+
+    for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+        for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+            Bitboard_t file = FILE_A_BB << COL_OF(sq);
+            Bitboard_t front = rowsInFront((ColorIndex_t)c, ROW_OF(sq));
+
+            forward_file[c][sq] = file & front;
+            passed_span[c][sq] = (file | adjacent_files[COL_OF(sq)]) & front;
+            support_span[c][sq] = adjacent_files[COL_OF(sq)] & ~front;
+        }
+    }
+
+    initialized = true;
+}
+
+static int shieldFor(Bitboard_t own, ColorIndex_t c, int king_col) {
+    int home_row = (c == WHITE_IDX) ? DIM_Y - 2 : 1;
+    int step = (c == WHITE_IDX) ? -1 : 1;
+    int score = 0;
+
+    for(int col = king_col - 1; col <= king_col + 1; col++) {
+        if(col < 0 || col >= DIM_X) continue;
+
+        if(own & BIT(SQUARE(home_row, col))) score += SHIELD_CLOSE;
+        else if(own & BIT(SQUARE(home_row + step, col))) score += SHIELD_FAR;
+        else score += SHIELD_MISSING;
+    }
+
+    return score;
+}
+
+void ComputePawns(const Board_t* board, PawnEntry_t* entry) {
+    int mg[COLOR_IDX_COUNT] = { 0, 0 };
+    int eg[COLOR_IDX_COUNT] = { 0, 0 };
+
+    entry->key = board->pawn_key;
+    entry->passed = 0;
+    entry->used = true;
+
+    for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+        ColorIndex_t them = (ColorIndex_t)(c ^ 1);
+        Bitboard_t own = board->bitboards[c][PAWN_IDX];
+        Bitboard_t enemy = board->bitboards[them][PAWN_IDX];
+
+        for(int col = 0; col < DIM_X; col++)
+            entry->shield[c][col] = (int8_t)shieldFor(own, (ColorIndex_t)c, col);
+
+        Bitboard_t pawns = own;
+        while(pawns) {
+            int sq = PopLsb(&pawns);
+            int rank = relativeRank((ColorIndex_t)c, sq);
+
+            if(forward_file[c][sq] & own) {
+                mg[c] += DOUBLED_MG;
+                eg[c] += DOUBLED_EG;
+            }
+
+            // only the front pawn of a doubled pair can be passed
+            if(!(passed_span[c][sq] & enemy) && !(forward_file[c][sq] & own)) {
+                mg[c] += passed_mg[rank];
+                eg[c] += passed_eg[rank];
+                entry->passed |= BIT(sq);
+            }
+
+            if(!(adjacent_files[COL_OF(sq)] & own)) {
+                mg[c] += ISOLATED_MG;
+                eg[c] += ISOLATED_EG;
+                continue;
+            }
+
+            // no pawn beside or behind can ever defend it, and an enemy pawn guards the square in front
+            int stop = sq + ((c == WHITE_IDX) ? -DIM_X : DIM_X);
+            if(!(support_span[c][sq] & own) && (PawnAttacks[c][stop] & enemy)) {
+                mg[c] += BACKWARD_MG;
+                eg[c] += BACKWARD_EG;
+            }
+        }
+    }
+
+    entry->mg = (int16_t)(mg[WHITE_IDX] - mg[BLACK_IDX]);
+    entry->eg = (int16_t)(eg[WHITE_IDX] - eg[BLACK_IDX]);
+}
+
+void ClearPawnTable(PawnTable_t* table) {
+    memset(table->entries, 0, sizeof(table->entries));
+    ResetPawnStats(table);
+}
+
+void ResetPawnStats(PawnTable_t* table) {
+    atomic_store_explicit(&table->probes, 0, memory_order_relaxed);
+    atomic_store_explicit(&table->hits, 0, memory_order_relaxed);
+}
+
+const PawnEntry_t* ProbePawns(PawnTable_t* table, const Board_t* board) {
+    PawnEntry_t* entry = &table->entries[board->pawn_key & (PAWN_TABLE_ENTRIES - 1)];
+
+    // plain load and store: only the owning thread writes
+    uint64_t probes = atomic_load_explicit(&table->probes, memory_order_relaxed);
+    atomic_store_explicit(&table->probes, probes + 1, memory_order_relaxed);
+
+    if(entry->used && entry->key == board->pawn_key) {
+        uint64_t hits = atomic_load_explicit(&table->hits, memory_order_relaxed);
+        atomic_store_explicit(&table->hits, hits + 1, memory_order_relaxed);
+        return entry;
+    }
+
+    ComputePawns(board, entry);
+    return entry;
+}
@@ -0,0 +1,23 @@
+#include "perft.h"
+
+uint64_t Perft(Board_t* board, int depth) {
+    if(depth == 0) return 1;
+
+    MoveList_t movelist;
+    movelist.size = 0;
+    GenerateMoves(board, &movelist);
+
+    // the generator is fully legal, so the last ply is just a count
+    if(depth == 1) return movelist.size;
+
+    uint64_t nodes = 0;
+
+    for(size_t i = 0; i < movelist.size; i++) {
+        UndoInfo_t undo;
+        MakeMove(board, movelist.moves[i], &undo);
+        nodes += Perft(board, depth - 1);
+        UnmakeMove(board, &undo);
+    }
+
+    return nodes;
+}
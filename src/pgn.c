@@ -0,0 +1,331 @@
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "pgn.h"
+#include "mapfile.h"
+
+#define MAX_SCAN_THREADS 256
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// characters that end a movetext token besides whitespace
+static inline bool isDelimiter(char c) {
+    return isSpace(c) || c == '{' || c == '}' || c == ';' || c == '(' || c == ')';
+}
+
+static inline const char* skipSpaces(const char* p, const char* end) {
+    while(p < end && isSpace(*p)) p++;
+    return p;
+}
+
+static inline bool spanEquals(const PgnSpan_t* span, const char* text, size_t length) {
+    return span->length == length && memcmp(span->text, text, length) == 0;
+}
+
+void PgnInitReader(PgnReader_t* reader, const char* text, size_t length) {
+    reader->start = reader->cursor = text;
+    reader->end = text + length;
+
+    // UTF-8 byte order mark, written by some Windows tools
+    if(length >= 3 && memcmp(text, "\xEF\xBB\xBF", 3) == 0) reader->cursor += 3;
+}
+
+// [Name "value"] at p. a malformed tag is dropped along with the rest of its line
+static const char* parseTag(const char* p, const char* end, PgnGame_t* game) {
+    const char* line_end = memchr(p, '\n', (size_t)(end - p));
+    if(!line_end) line_end = end;
+
+    p = skipSpaces(p + 1, line_end);
+    const char* name = p;
+    while(p < line_end && !isSpace(*p) && *p != '"' && *p != ']') p++;
+    size_t name_length = (size_t)(p - name);
+
+    p = skipSpaces(p, line_end);
+    if(name_length == 0 || p == line_end || *p != '"') return line_end;
+
+    const char* value = ++p;
+    while(p < line_end && *p != '"') p += (*p == '\\' && p + 1 < line_end) ? 2 : 1;
+    if(p >= line_end) return line_end;
+
+    if(game->tag_count < PGN_MAX_TAGS) {
+        game->tags[game->tag_count++] = (PgnTag_t){
+            .name = { name, name_length },
+            .value = { value, (size_t)(p - value) }
+        };
+    }
+
+    const char* close = memchr(p, ']', (size_t)(line_end - p));
+    return close ? close + 1 : line_end;
+}
+
+bool PgnNextGame(PgnReader_t* reader, PgnGame_t* game) {
+    const char* end = reader->end;
+    const char* p = skipSpaces(reader->cursor, end);
+    if(p == end) {
+        reader->cursor = end;
+        return false;
+    }
+
+    game->tag_count = 0;
+    game->offset = (size_t)(p - reader->start);
+
+    // a blank line after a tag also ends the tag section, so a game without movetext doesn't swallow the next one
+    while(p < end && *p == '[') {
+        p = parseTag(p, end, game);
+
+        int newlines = 0;
+        while(p < end && isSpace(*p)) newlines += *p++ == '\n';
+        if(newlines > 1) break;
+    }
+
+    // still on a '[' here means the tags ended at a blank line and the next game follows: no movetext
+    const char* movetext = p;
+    while(p < end && *p != '[') {
+        const char* newline = memchr(p, '\n', (size_t)(end - p));
+        if(!newline) {
+            p = end;
+            break;
+        }
+
+        p = newline + 1;
+        if(p < end && *p == '[') break;
+    }
+
+    game->movetext = (PgnSpan_t){ movetext, (size_t)(p - movetext) };
+    reader->cursor = p;
+    return true;
+}
+
+const PgnSpan_t* PgnFindTag(const PgnGame_t* game, const char* name) {
+    size_t length = strlen(name);
+
+    for(int i = 0; i < game->tag_count; i++) {
+        if(spanEquals(&game->tags[i].name, name, length)) return &game->tags[i].value;
+    }
+
+    return NULL;
+}
+
+static bool isResult(const char* token, size_t length) {
+    PgnSpan_t span = { token, length };
+    return spanEquals(&span, "1-0", 3) || spanEquals(&span, "0-1", 3) || spanEquals(&span, "1/2-1/2", 7)
+        || spanEquals(&span, "*", 1);
+}
+
+bool PgnNextMove(const char** cursor, const char* end, PgnSpan_t* san) {
+    const char* p = *cursor;
+    int depth = 0; // inside recursive variations
+
+    while(p < end) {
+        char c = *p;
+
+        if(isSpace(c)) {
+            p++;
+        } else if(c == '{') {
+            const char* close = memchr(p, '}', (size_t)(end - p));
+            p = close ? close + 1 : end;
+        } else if(c == ';') {
+            const char* newline = memchr(p, '\n', (size_t)(end - p));
+            p = newline ? newline + 1 : end;
+        } else if(c == '(') {
+            depth++;
+            p++;
+        } else if(c == ')' || c == '}') {
+            if(c == ')' && depth > 0) depth--;
+            p++;
+        } else {
+            const char* token = p;
+            while(p < end && !isDelimiter(*p)) p++;
+            if(depth > 0 || c == '$') continue;
+
+            size_t length = (size_t)(p - token);
+            if(isResult(token, length)) {
+                *cursor = p;
+                return false;
+            }
+
+            // move numbers: "12." and "12..." alone or glued to the move, as in "12.e4"
+            const char* move = token;
+            while(move < p && *move >= '0' && *move <= '9') move++;
+            if(move < p && *move == '.') {
+                while(move < p && *move == '.') move++;
+            } else {
+                move = token;
+            }
+            if(move == p) continue;
+
+            san->text = move;
+            san->length = (size_t)(p - move);
+            *cursor = p;
+            return true;
+        }
+    }
+
+    *cursor = end;
+    return false;
+}
+
+PgnError_t PgnReplayGame(const PgnGame_t* game, Board_t* board, PgnReplay_t* replay) {
+    replay->plies = 0;
+    replay->bad_move = (PgnSpan_t){ NULL, 0 };
+
+    const PgnSpan_t* fen = PgnFindTag(game, "FEN");
+    if(fen) {
+        FenPosition_t position;
+        if(ParseFen(fen->text, fen->length, &position, NULL) != FEN_OK) {
+            InitBoard(board);
+            return PGN_ERROR_FEN;
+        }
+
+        InitBoardFromPosition(board, &position);
+    } else {
+        InitBoard(board);
+    }
+
+    const char* cursor = game->movetext.text;
+    const char* end = cursor + game->movetext.length;
+    PgnSpan_t san;
+
+    while(PgnNextMove(&cursor, end, &san)) {
+        if(replay->plies == MAX_GAME_PLY) return PGN_ERROR_LENGTH;
+
+        PackedMove_t move = SanToMove(board, san.text, san.length);
+        if(move == NO_MOVE) {
+            replay->bad_move = san;
+            return PGN_ERROR_MOVE;
+        }
+
+        MakeMove(board, move, &replay->undo[replay->plies++]);
+    }
+
+    return PGN_OK;
+}
+
+const char* PgnErrorString(PgnError_t error) {
+    switch(error) {
+        case PGN_OK:           return "ok";
+        case PGN_ERROR_FEN:    return "bad FEN tag";
+        case PGN_ERROR_MOVE:   return "illegal or ambiguous move";
+        case PGN_ERROR_LENGTH: return "game too long";
+        case PGN_ERROR_COUNT:  break;
+    }
+
+    return "unknown error";
+}
+
+typedef struct PgnWorker {
+    PgnReader_t reader;
+    int thread;
+
+    PgnGameCallback_t on_game;
+    void* data;
+
+    PgnStats_t stats;
+    Board_t board;
+    PgnReplay_t replay;
+} PgnWorker_t;
+
+static int scanChunk(void* data) {
+    PgnWorker_t* worker = data;
+    PgnGame_t game;
+
+    while(PgnNextGame(&worker->reader, &game)) {
+        PgnError_t error = PgnReplayGame(&game, &worker->board, &worker->replay);
+
+        worker->stats.games++;
+        worker->stats.plies += (uint64_t)worker->replay.plies;
+        if(error != PGN_OK) worker->stats.failed[error]++;
+
+        if(worker->on_game)
+            worker->on_game(&game, &worker->board, &worker->replay, error, worker->thread, worker->data);
+    }
+
+    return 0;
+}
+
+// the first game at or after p: a line starting with '[' that doesn't follow another tag line
+static const char* nextGameStart(const char* start, const char* p, const char* end) {
+    while(p < end) {
+        const char* newline = memchr(p, '\n', (size_t)(end - p));
+        if(!newline) return end;
+
+        p = newline + 1;
+        if(p == end || *p != '[') continue;
+
+        const char* previous = newline;
+        while(previous > start && previous[-1] != '\n') previous--;
+        if(*previous != '[') return p;
+    }
+
+    return end;
+}
+
+bool PgnScanFile(const char* path, int threads, PgnGameCallback_t on_game, void* data, PgnStats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    MappedFile_t file;
+    if(!MapFile(path, &file, true)) {
+        ERROR("Failed to open PGN file %s", path);
+        return false;
+    }
+
+    if(threads < 1) threads = 1;
+    if(threads > MAX_SCAN_THREADS) threads = MAX_SCAN_THREADS;
+
+    PgnWorker_t* workers = malloc((size_t)threads * sizeof(PgnWorker_t));
+    if(!workers) {
+        ERROR("Out of memory for %d PGN threads", threads);
+        UnmapFile(&file);
+        return false;
+    }
+
+    const char* text = (const char*)file.data;
+    const char* end = text + file.size;
+
+    // even byte ranges, each moved forward to the start of a game
+    const char* begin = text;
+    for(int i = 0; i < threads; i++) {
+        const char* stop = end;
+        if(i < threads - 1) {
+            stop = text + file.size * (size_t)(i + 1) / (size_t)threads;
+            stop = (stop <= begin) ? begin : nextGameStart(text, stop - 1, end);
+        }
+
+        PgnWorker_t* worker = &workers[i];
+        PgnInitReader(&worker->reader, text, file.size);
+        if(i > 0) worker->reader.cursor = begin;
+        worker->reader.end = stop;
+        worker->thread = i;
+        worker->on_game = on_game;
+        worker->data = data;
+        memset(&worker->stats, 0, sizeof(worker->stats));
+
+        begin = stop;
+    }
+
+    thrd_t handles[MAX_SCAN_THREADS];
+    bool started[MAX_SCAN_THREADS] = { false };
+
+    for(int i = 1; i < threads; i++)
+        started[i] = thrd_create(&handles[i], scanChunk, &workers[i]) == thrd_success;
+
+    scanChunk(&workers[0]);
+
+    for(int i = 1; i < threads; i++) {
+        if(started[i]) thrd_join(handles[i], NULL);
+        else scanChunk(&workers[i]);
+    }
+
+    for(int i = 0; i < threads; i++) {
+        stats->games += workers[i].stats.games;
+        stats->plies += workers[i].stats.plies;
+        for(int e = 0; e < PGN_ERROR_COUNT; e++) stats->failed[e] += workers[i].stats.failed[e];
+    }
+    stats->bytes = file.size;
+
+    free(workers);
+    UnmapFile(&file);
+    return true;
+}
@@ -0,0 +1,767 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include "search.h"
+#include "evaluate.h"
+#include "tt.h"
+#include "movepick.h"
+#include "see.h"
+#include "nnue.h"
+#include "timer.h"
+#include "tablebase.h"
+
+// how often the clock and node limit are looked at
+#define CHECK_INTERVAL 2048
+
+// a capture that can't bring the score within this of alpha isn't searched in quiescence
+#define DELTA_MARGIN 200
+
+// set by StopSearch or by the main thread when a limit is hit, read by every thread
+static atomic_bool stop_requested;
+
+/*
+    Everything one search thread writes to. Each thread searches its own
+    copy of the board, so the transposition table is the only thing
+    threads share while searching.
+*/
+typedef struct SearchThread {
+    int id; // 0 runs on the caller's thread and owns the limits and reports
+
+    Board_t board;
+    const SearchLimits_t* limits;
+    int64_t start_ms;
+    int64_t clock_ms; // movetime counts from here, the start or the ponderhit
+    bool pondering;
+
+    // only the owner writes, the main thread sums them for limits and reports
+    _Atomic uint64_t nodes;
+    bool stopped;
+
+    // triangular PV table, row ply holds the line found from that ply
+    PackedMove_t pv[MAX_PLY][MAX_PLY];
+    int pv_length[MAX_PLY];
+    PackedMove_t prev_pv[MAX_PLY]; // best line of the last finished iteration
+
+    // keys of every position before the current one, game history first
+    uint64_t keys[MAX_GAME_PLY + MAX_PLY];
+    int key_count;
+
+    PawnTable_t pawns;
+
+    // network accumulators along the current line, brought up to date only when a node evaluates
+    bool use_nnue;
+    Accumulator_t acc[MAX_PLY + 1];
+    UndoInfo_t acc_undo[MAX_PLY + 1]; // the move that led to each ply
+    bool acc_ready[MAX_PLY + 1];
+
+    // move ordering, see movepick.h
+    PackedMove_t killers[MAX_PLY][2];
+    History_t history[COLOR_IDX_COUNT];
+
+    // result of the last finished iteration, for the vote
+    int completed_depth;
+    int completed_score;
+    int completed_pv_length;
+
+    uint64_t generation; // last search a helper picked up
+} SearchThread_t;
+
+/*
+    Helpers (index 1 and up) sleep on wake between searches. The main
+    thread bumps generation to start them and waits on done until the
+    last one has returned. The lock only guards the hand-off, never the
+    search itself.
+*/
+static struct {
+    SearchThread_t** threads;
+    thrd_t* handles;
+    int count;
+
+    mtx_t lock;
+    cnd_t wake;
+    cnd_t done;
+    bool sync_ready;
+
+    uint64_t generation;
+    int running;
+    bool quit;
+} pool;
+
+/*
+    Depth staggering: helper i skips some iterations so the threads spread
+    over neighbouring depths instead of all searching the same tree.
+    Helper i skips depth d when ((d + phase) / size) is odd.
+*/
+static const int skip_size[]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const int skip_phase[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+#define SKIP_COUNT ((int)(sizeof(skip_size) / sizeof(skip_size[0])))
+
+static bool skipDepth(int id, int depth) {
+    if(id == 0) return false;
+
+    int i = (id - 1) % SKIP_COUNT;
+    return ((depth + skip_phase[i]) / skip_size[i]) % 2 != 0;
+}
+
+static uint64_t totalNodes(void) {
+    uint64_t nodes = 0;
+
+    for(int i = 0; i < pool.count; i++)
+        nodes += atomic_load_explicit(&pool.threads[i]->nodes, memory_order_relaxed);
+
+    return nodes;
+}
+
+static void totalPawnStats(uint64_t* probes, uint64_t* hits) {
+    *probes = *hits = 0;
+
+    for(int i = 0; i < pool.count; i++) {
+        *probes += atomic_load_explicit(&pool.threads[i]->pawns.probes, memory_order_relaxed);
+        *hits += atomic_load_explicit(&pool.threads[i]->pawns.hits, memory_order_relaxed);
+    }
+}
+
+static int pawnHitRate(void) {
+    uint64_t probes, hits;
+    totalPawnStats(&probes, &hits);
+
+    return probes ? (int)(hits * 1000 / probes) : 0;
+}
+
+void StopSearch(void) {
+    atomic_store(&stop_requested, true);
+}
+
+// helpers only follow the stop flag, the main thread also enforces the limits for everyone
+static void checkLimits(SearchThread_t* t) {
+    const SearchLimits_t* limits = t->limits;
+
+    if(atomic_load_explicit(&stop_requested, memory_order_relaxed)) {
+        t->stopped = true;
+        return;
+    }
+
+    if(t->id != 0) return;
+
+    if(limits->stop && atomic_load(limits->stop)) {
+        atomic_store(&stop_requested, true);
+        t->stopped = true;
+        return;
+    }
+
+    if(limits->infinite) return;
+
+    if(t->pondering) {
+        if(atomic_load(limits->ponder)) return;
+
+        t->pondering = false;
+        t->clock_ms = NowMs();
+    }
+
+    if((limits->nodes && totalNodes() >= limits->nodes)
+        || (limits->movetime && NowMs() - t->clock_ms >= limits->movetime)) {
+        atomic_store(&stop_requested, true);
+        t->stopped = true;
+    }
+}
+
+// only positions since the last capture or pawn move can repeat
+static bool isRepetition(const SearchThread_t* t) {
+    const Board_t* board = &t->board;
+    int oldest = t->key_count - board->halfmove;
+    if(oldest < 0) oldest = 0;
+
+    for(int i = t->key_count - 2; i >= oldest; i -= 2) {
+        if(t->keys[i] == board->key) return true;
+    }
+
+    return false;
+}
+
+// mate scores are stored relative to the node, not the root, so they stay valid at any ply
+static int scoreToTT(int score, int ply) {
+    if(score >= SCORE_MATE_IN_MAX) return score + ply;
+    if(score <= -SCORE_MATE_IN_MAX) return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if(score >= SCORE_MATE_IN_MAX) return score - ply;
+    if(score <= -SCORE_MATE_IN_MAX) return score + ply;
+    return score;
+}
+
+_Static_assert(MAX_PLY + TB_MAX_PLIES <= MAX_MATE_PLIES, "tablebase mates must stay mate scores");
+
+// a tablebase result as a search score: the exact mate distance from the root
+static int scoreFromTablebase(const TbResult_t* result, int ply) {
+    if(result->wdl == TB_WIN) return SCORE_MATE - (ply + result->plies);
+    if(result->wdl == TB_LOSS) return -SCORE_MATE + (ply + result->plies);
+    return 0;
+}
+
+// a quiet move that caused a cutoff is tried early at the same ply and from the same squares
+static void updateQuietStats(SearchThread_t* t, PackedMove_t move, const PackedMove_t* tried, int tried_count,
+                             int depth, int ply) {
+    History_t* history = &t->history[ColorToIndex(t->board.turn)];
+    int bonus = depth * depth;
+
+    UpdateHistory(history, move, bonus);
+    for(int i = 0; i < tried_count; i++)
+        UpdateHistory(history, tried[i], -bonus);
+
+    if(t->killers[ply][0] != move) {
+        t->killers[ply][1] = t->killers[ply][0];
+        t->killers[ply][0] = move;
+    }
+}
+
+// counts the node and looks at the limits every CHECK_INTERVAL nodes. true if the search must unwind
+static bool enterNode(SearchThread_t* t, int ply) {
+    t->pv_length[ply] = ply;
+
+    // a plain load and store, no locked add: nobody else writes this counter
+    uint64_t nodes = atomic_load_explicit(&t->nodes, memory_order_relaxed) + 1;
+    atomic_store_explicit(&t->nodes, nodes, memory_order_relaxed);
+
+    if((nodes & (CHECK_INTERVAL - 1)) == 0)
+        checkLimits(t);
+
+    return t->stopped;
+}
+
+static void updatePV(SearchThread_t* t, PackedMove_t move, int ply) {
+    t->pv[ply][ply] = move;
+    for(int next = ply + 1; next < t->pv_length[ply + 1]; next++)
+        t->pv[ply][next] = t->pv[ply + 1][next];
+    t->pv_length[ply] = t->pv_length[ply + 1];
+}
+
+static void makeMove(SearchThread_t* t, PackedMove_t move, UndoInfo_t* undo, int ply) {
+    t->keys[t->key_count++] = t->board.key;
+    MakeMove(&t->board, move, undo);
+    TTPrefetch(t->board.key);
+
+    if(t->use_nnue) {
+        t->acc_undo[ply + 1] = *undo;
+        t->acc_ready[ply + 1] = false;
+    }
+}
+
+static void unmakeMove(SearchThread_t* t, const UndoInfo_t* undo) {
+    UnmakeMove(&t->board, undo);
+    t->key_count--;
+}
+
+// with a network, catch the accumulators up from the last ply that has one (the root always does)
+static int staticEval(SearchThread_t* t, int ply) {
+    if(!t->use_nnue) return Evaluate(&t->board, &t->pawns);
+
+    int ready = ply;
+    while(!t->acc_ready[ready]) ready--;
+
+    for(int p = ready + 1; p <= ply; p++) {
+        NnueUpdate(&t->acc[p], &t->acc[p - 1], &t->acc_undo[p]);
+        t->acc_ready[p] = true;
+    }
+
+    return NnueEvaluate(&t->acc[ply], t->board.turn);
+}
+
+// value a noisy move takes off the board, promotions included
+static int gainOf(const Board_t* board, PackedMove_t move) {
+    int gain = 0;
+
+    if(MoveFlags(move) == FLAG_EN_PASSANT)
+        gain = PieceValues[PAWN_IDX];
+    else if(IsCapture(move))
+        gain = PieceValues[PieceToIndex(board->pieces[MoveTo(move)].type)];
+
+    if(IsPromotion(move))
+        gain += PieceValues[PieceToIndex(PromotionPiece(move))] - PieceValues[PAWN_IDX];
+
+    return gain;
+}
+
+/*
+    Captures only, until the position is quiet. The side to move may
+    always "stand pat" on the static eval instead of capturing. Captures
+    that lose material by SEE, or that can't lift the score to alpha even
+    if they win the piece outright (delta pruning), are skipped. In check
+    every evasion is searched and standing pat isn't allowed.
+*/
+static int quiescence(SearchThread_t* t, int alpha, int beta, int ply) {
+    Board_t* board = &t->board;
+
+    if(enterNode(t, ply)) return 0;
+
+    if(ply >= MAX_PLY - 1)
+        return staticEval(t, ply);
+
+    bool pv_node = beta - alpha > 1;
+    PackedMove_t hash_move = NO_MOVE;
+    TTData_t tt;
+
+    if(TTProbe(board->key, &tt)) {
+        hash_move = tt.move;
+
+        if(!pv_node) {
+            int score = scoreFromTT(tt.score, ply);
+
+            if(tt.bound == TT_BOUND_EXACT
+                || (tt.bound == TT_BOUND_LOWER && score >= beta)
+                || (tt.bound == TT_BOUND_UPPER && score <= alpha))
+                return score;
+        }
+    }
+
+    bool in_check = IsCheck(board, board->turn);
+    int alpha_orig = alpha;
+    int best = -SCORE_INFINITE;
+    int stand_pat = -SCORE_INFINITE;
+
+    if(!in_check) {
+        stand_pat = best = staticEval(t, ply);
+        if(best >= beta) return best;
+        if(best > alpha) alpha = best;
+    }
+
+    MovePicker_t picker;
+    if(in_check)
+        InitMovePicker(&picker, board, hash_move, NULL, NULL);
+    else
+        InitQuiescencePicker(&picker, board, hash_move);
+
+    PackedMove_t best_move = NO_MOVE;
+    int played = 0;
+    PackedMove_t move;
+
+    while((move = NextMove(&picker)) != NO_MOVE) {
+        if(!in_check) {
+            if(!IsPromotion(move) && stand_pat + gainOf(board, move) + DELTA_MARGIN <= alpha)
+                continue;
+
+            if(!SeeGE(board, move, 0))
+                continue;
+        }
+
+        UndoInfo_t undo;
+        makeMove(t, move, &undo, ply);
+        played++;
+
+        int score = -quiescence(t, -beta, -alpha, ply + 1);
+
+        unmakeMove(t, &undo);
+
+        if(t->stopped) return 0;
+
+        if(score > best) {
+            best = score;
+            best_move = move;
+
+            if(score > alpha) {
+                alpha = score;
+                updatePV(t, move, ply);
+
+                if(alpha >= beta) break;
+            }
+        }
+    }
+
+    if(in_check && played == 0)
+        return -SCORE_MATE + ply;
+
+    TTBound_t bound = (best >= beta) ? TT_BOUND_LOWER
+                    : (best > alpha_orig) ? TT_BOUND_EXACT : TT_BOUND_UPPER;
+    TTStore(board->key, (bound == TT_BOUND_UPPER) ? NO_MOVE : best_move, scoreToTT(best, ply), 0, bound);
+
+    return best;
+}
+
+static int alphaBeta(SearchThread_t* t, int depth, int alpha, int beta, int ply) {
+    Board_t* board = &t->board;
+
+    t->pv_length[ply] = ply;
+
+    if(ply > 0 && (board->halfmove >= 100 || isRepetition(t)))
+        return 0;
+
+    // exact, so ahead of the horizon too. the root still searches, so it picks among moves with exact results
+    TbResult_t tablebase;
+    if(ply > 0 && TbProbe(board, &tablebase))
+        return scoreFromTablebase(&tablebase, ply);
+
+    bool in_check = IsCheck(board, board->turn);
+
+    // out of depth, settle the captures first. never from check, that's extended instead
+    if(depth <= 0 && !in_check)
+        return quiescence(t, alpha, beta, ply);
+
+    if(enterNode(t, ply)) return 0;
+
+    if(in_check) depth++;
+
+    if(ply >= MAX_PLY - 1)
+        return staticEval(t, ply);
+
+    bool pv_node = beta - alpha > 1;
+    PackedMove_t hash_move = NO_MOVE;
+    TTData_t tt;
+
+    if(TTProbe(board->key, &tt)) {
+        hash_move = tt.move;
+
+        // PV nodes always search, so the PV isn't cut short by a stored bound
+        if(!pv_node && ply > 0 && tt.depth >= depth) {
+            int score = scoreFromTT(tt.score, ply);
+
+            if(tt.bound == TT_BOUND_EXACT
+                || (tt.bound == TT_BOUND_LOWER && score >= beta)
+                || (tt.bound == TT_BOUND_UPPER && score <= alpha))
+                return score;
+        }
+    }
+
+    // the root can fall back on the last iteration if the entry was overwritten
+    if(ply == 0 && hash_move == NO_MOVE)
+        hash_move = t->prev_pv[0];
+
+    MovePicker_t picker;
+    InitMovePicker(&picker, board, hash_move, t->killers[ply], &t->history[ColorToIndex(board->turn)]);
+
+    int alpha_orig = alpha;
+    int best = -SCORE_INFINITE;
+    PackedMove_t best_move = NO_MOVE;
+
+    PackedMove_t quiets[MAX_MOVES]; // tried without a cutoff, lose history on one
+    int quiet_count = 0;
+    int played = 0;
+    PackedMove_t move;
+
+    while((move = NextMove(&picker)) != NO_MOVE) {
+        UndoInfo_t undo;
+        int score;
+        bool quiet = !IsCapture(move) && !IsPromotion(move);
+
+        makeMove(t, move, &undo, ply);
+
+        if(played++ == 0) {
+            score = -alphaBeta(t, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            // null window first, re-search only if it might be the new best
+            score = -alphaBeta(t, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if(score > alpha && score < beta)
+                score = -alphaBeta(t, depth - 1, -beta, -alpha, ply + 1);
+        }
+
+        unmakeMove(t, &undo);
+
+        if(t->stopped) return 0;
+
+        if(score > best) {
+            best = score;
+            best_move = move;
+
+            if(score > alpha) {
+                alpha = score;
+
+                updatePV(t, move, ply);
+
+                if(alpha >= beta) {
+                    if(quiet) updateQuietStats(t, move, quiets, quiet_count, depth, ply);
+                    break;
+                }
+            }
+        }
+
+        if(quiet) quiets[quiet_count++] = move;
+    }
+
+    if(played == 0)
+        return in_check ? -SCORE_MATE + ply : 0;
+
+    TTBound_t bound = (best >= beta) ? TT_BOUND_LOWER
+                    : (best > alpha_orig) ? TT_BOUND_EXACT : TT_BOUND_UPPER;
+    TTStore(board->key, (bound == TT_BOUND_UPPER) ? NO_MOVE : best_move, scoreToTT(best, ply), depth, bound);
+
+    return best;
+}
+
+static void reportIteration(const SearchThread_t* t, int depth, int score) {
+    SearchInfo_t info;
+    info.depth = depth;
+    info.score = score;
+    info.nodes = totalNodes();
+    info.time_ms = NowMs() - t->start_ms;
+    info.nps = info.nodes * 1000 / (uint64_t)(info.time_ms > 0 ? info.time_ms : 1);
+    info.hashfull = TTHashfull();
+    info.pawn_hits = pawnHitRate();
+    info.pv_length = t->pv_length[0];
+    memcpy(info.pv, t->pv[0], info.pv_length * sizeof(PackedMove_t));
+
+    t->limits->report(&info, t->limits->report_data);
+}
+
+static void iterativeDeepening(SearchThread_t* t) {
+    const SearchLimits_t* limits = t->limits;
+    int max_depth = (limits->depth > 0 && limits->depth < MAX_PLY) ? limits->depth : MAX_PLY - 1;
+
+    for(int depth = 1; depth <= max_depth; depth++) {
+        if(depth > 1 && skipDepth(t->id, depth)) continue;
+
+        int score = alphaBeta(t, depth, -SCORE_INFINITE, SCORE_INFINITE, 0);
+
+        if(t->stopped) break;
+
+        memset(t->prev_pv, 0, sizeof(t->prev_pv));
+        memcpy(t->prev_pv, t->pv[0], t->pv_length[0] * sizeof(PackedMove_t));
+
+        t->completed_depth = depth;
+        t->completed_score = score;
+        t->completed_pv_length = t->pv_length[0];
+
+        if(t->id == 0 && limits->report)
+            reportIteration(t, depth, score);
+
+        // a found mate won't get shorter by searching deeper
+        if(abs(score) >= SCORE_MATE_IN_MAX && !limits->infinite) break;
+    }
+}
+
+static int helperMain(void* arg) {
+    SearchThread_t* t = arg;
+
+    mtx_lock(&pool.lock);
+
+    for(;;) {
+        while(!pool.quit && t->generation == pool.generation)
+            cnd_wait(&pool.wake, &pool.lock);
+
+        if(pool.quit) break;
+
+        t->generation = pool.generation;
+        mtx_unlock(&pool.lock);
+
+        iterativeDeepening(t);
+
+        mtx_lock(&pool.lock);
+        if(--pool.running == 0)
+            cnd_signal(&pool.done);
+    }
+
+    mtx_unlock(&pool.lock);
+    return 0;
+}
+
+static void stopHelpers(void) {
+    if(pool.count == 0) return;
+
+    mtx_lock(&pool.lock);
+    pool.quit = true;
+    cnd_broadcast(&pool.wake);
+    mtx_unlock(&pool.lock);
+
+    for(int i = 1; i < pool.count; i++)
+        thrd_join(pool.handles[i], NULL);
+
+    for(int i = 0; i < pool.count; i++)
+        free(pool.threads[i]);
+
+    free(pool.threads);
+    free(pool.handles);
+
+    pool.threads = NULL;
+    pool.handles = NULL;
+    pool.count = 0;
+    pool.quit = false;
+}
+
+bool SetSearchThreads(int count) {
+    if(count < 1) count = 1;
+    if(count > MAX_SEARCH_THREADS) count = MAX_SEARCH_THREADS;
+
+    if(!pool.sync_ready) {
+        if(mtx_init(&pool.lock, mtx_plain) != thrd_success
+            || cnd_init(&pool.wake) != thrd_success
+            || cnd_init(&pool.done) != thrd_success) {
+            ERROR("Failed to create the search thread pool");
+            return false;
+        }
+        pool.sync_ready = true;
+    }
+
+    stopHelpers();
+
+    pool.threads = calloc((size_t)count, sizeof(SearchThread_t*));
+    pool.handles = calloc((size_t)count, sizeof(thrd_t));
+    if(!pool.threads || !pool.handles) {
+        ERROR("Failed to allocate %d search threads", count);
+        free(pool.threads);
+        free(pool.handles);
+        pool.threads = NULL;
+        pool.handles = NULL;
+        return false;
+    }
+
+    for(int i = 0; i < count; i++) {
+        SearchThread_t* t = calloc(1, sizeof(SearchThread_t));
+        if(!t) {
+            ERROR("Failed to allocate search state for thread %d", i);
+            break;
+        }
+
+        t->id = i;
+        t->generation = pool.generation;
+        pool.threads[i] = t;
+
+        if(i > 0 && thrd_create(&pool.handles[i], helperMain, t) != thrd_success) {
+            ERROR("Failed to start search thread %d", i);
+            free(t);
+            pool.threads[i] = NULL;
+            break;
+        }
+
+        pool.count = i + 1;
+    }
+
+    if(pool.count < count)
+        WARN("Searching with %d of %d threads", pool.count, count);
+
+    return pool.count > 0;
+}
+
+int GetSearchThreads(void) {
+    return pool.count;
+}
+
+void FreeSearchThreads(void) {
+    stopHelpers();
+}
+
+static void prepareThread(SearchThread_t* t, const Board_t* board, const SearchLimits_t* limits, int64_t start_ms) {
+    CopyBoard(&t->board, board);
+
+    t->limits = limits;
+    t->start_ms = t->clock_ms = start_ms;
+    t->pondering = limits->ponder != NULL;
+    atomic_store_explicit(&t->nodes, 0, memory_order_relaxed);
+    ResetPawnStats(&t->pawns);
+    t->stopped = false;
+
+    t->key_count = 0;
+    for(size_t i = 0; i < board->History.size; i++)
+        t->keys[t->key_count++] = board->History.states[i].key;
+
+    t->use_nnue = NnueLoaded();
+    if(t->use_nnue) {
+        NnueRefresh(&t->acc[0], &t->board);
+        t->acc_ready[0] = true;
+    }
+
+    memset(t->prev_pv, 0, sizeof(t->prev_pv));
+    memset(t->killers, 0, sizeof(t->killers));
+
+    // keep what the last search learned, but let this one overrule it quickly
+    for(int c = 0; c < COLOR_IDX_COUNT; c++)
+        for(int from = 0; from < SQUARE_COUNT; from++)
+            for(int to = 0; to < SQUARE_COUNT; to++)
+                t->history[c][from][to] /= 2;
+
+    t->completed_depth = 0;
+    t->completed_pv_length = 0;
+}
+
+/*
+    Threads that agree on a move pool their votes, weighted by how deep
+    they got and how much better their score is than the worst one. This
+    beats simply trusting the main thread when helpers got further.
+*/
+static SearchThread_t* pickBestThread(void) {
+    SearchThread_t* best = pool.threads[0];
+    if(pool.count == 1) return best;
+
+    int min_score = SCORE_INFINITE;
+    for(int i = 0; i < pool.count; i++) {
+        SearchThread_t* t = pool.threads[i];
+        if(t->completed_depth > 0 && t->completed_score < min_score)
+            min_score = t->completed_score;
+    }
+
+    int64_t best_votes = -1;
+
+    for(int i = 0; i < pool.count; i++) {
+        SearchThread_t* candidate = pool.threads[i];
+        if(candidate->completed_depth == 0) continue;
+
+        int64_t votes = 0;
+        for(int j = 0; j < pool.count; j++) {
+            SearchThread_t* t = pool.threads[j];
+            if(t->completed_depth > 0 && t->prev_pv[0] == candidate->prev_pv[0])
+                votes += (int64_t)(t->completed_score - min_score + 14) * t->completed_depth;
+        }
+
+        if(votes > best_votes) {
+            best_votes = votes;
+            best = candidate;
+        }
+    }
+
+    return best;
+}
+
+SearchResult_t SearchPosition(Board_t* board, const SearchLimits_t* limits) {
+    SearchResult_t result = { .best_move = NO_MOVE, .ponder_move = NO_MOVE };
+
+    if(pool.count == 0 && !SetSearchThreads(1))
+        return result;
+
+    // something to play even if stopped before the first iteration ends
+    MoveList_t root;
+    root.size = 0;
+    GenerateMoves(board, &root);
+    if(root.size == 0) return result;
+    result.best_move = root.moves[0];
+
+    atomic_store(&stop_requested, false);
+
+    if(TTSizeMB() == 0) TTResize(TT_DEFAULT_MB);
+    TTNewSearch();
+
+    int64_t start_ms = NowMs();
+    for(int i = 0; i < pool.count; i++)
+        prepareThread(pool.threads[i], board, limits, start_ms);
+
+    mtx_lock(&pool.lock);
+    pool.generation++;
+    pool.running = pool.count - 1;
+    cnd_broadcast(&pool.wake);
+    mtx_unlock(&pool.lock);
+
+    iterativeDeepening(pool.threads[0]);
+
+    // infinite searches only end on a stop, even after the last depth. so do ponder searches until the ponderhit
+    while((limits->infinite || (limits->ponder && atomic_load(limits->ponder)))
+        && !atomic_load(&stop_requested) && !(limits->stop && atomic_load(limits->stop)))
+        thrd_sleep(&(struct timespec){ .tv_nsec = 1000000 }, NULL);
+
+    atomic_store(&stop_requested, true);
+
+    mtx_lock(&pool.lock);
+    while(pool.running > 0)
+        cnd_wait(&pool.done, &pool.lock);
+    mtx_unlock(&pool.lock);
+
+    SearchThread_t* best = pickBestThread();
+
+    if(best->completed_depth > 0) {
+        result.best_move = best->prev_pv[0];
+        result.ponder_move = (best->completed_pv_length > 1) ? best->prev_pv[1] : NO_MOVE;
+        result.score = best->completed_score;
+        result.depth = best->completed_depth;
+    }
+
+    result.nodes = totalNodes();
+    totalPawnStats(&result.pawn_probes, &result.pawn_hits);
+    return result;
+}
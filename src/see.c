@@ -0,0 +1,73 @@
+#include "see.h"
+#include "evaluate.h"
+#include "magic.h"
+
+// cheapest piece of color c among attackers, PIECE_IDX_COUNT if none
+static PieceIndex_t leastValuable(const Board_t* board, Bitboard_t attackers, ColorIndex_t c, Bitboard_t* from) {
+    for(int p = PAWN_IDX; p < PIECE_IDX_COUNT; p++) {
+        Bitboard_t bb = attackers & board->bitboards[c][p];
+        if(bb) {
+            *from = bb & -bb;
+            return (PieceIndex_t)p;
+        }
+    }
+
+    return PIECE_IDX_COUNT;
+}
+
+bool SeeGE(const Board_t* board, PackedMove_t move, int threshold) {
+    int flags = MoveFlags(move);
+    if(flags != FLAG_QUIET && flags != FLAG_DOUBLE_PUSH && flags != FLAG_CAPTURE)
+        return threshold <= 0;
+
+    int from = MoveFrom(move), to = MoveTo(move);
+
+    // what we win if nothing recaptures
+    PieceType_t victim = board->pieces[to].type;
+    int swap = (victim == PIECE_NONE ? 0 : PieceValues[PieceToIndex(victim)]) - threshold;
+    if(swap < 0) return false;
+
+    // what we still have if our piece is lost right back
+    swap = PieceValues[PieceToIndex(board->pieces[from].type)] - swap;
+    if(swap <= 0) return true;
+
+    const Bitboard_t (*bb)[PIECE_IDX_COUNT] = board->bitboards;
+    Bitboard_t diagonal = bb[WHITE_IDX][BISHOP_IDX] | bb[WHITE_IDX][QUEEN_IDX] |
+                          bb[BLACK_IDX][BISHOP_IDX] | bb[BLACK_IDX][QUEEN_IDX];
+    Bitboard_t straight = bb[WHITE_IDX][ROOK_IDX] | bb[WHITE_IDX][QUEEN_IDX] |
+                          bb[BLACK_IDX][ROOK_IDX] | bb[BLACK_IDX][QUEEN_IDX];
+
+    Bitboard_t occupied = board->occupied ^ BIT(from) ^ BIT(to);
+    Bitboard_t attackers = AttackersTo(board, to, occupied);
+    ColorIndex_t side = ColorToIndex(board->pieces[from].color);
+
+    // res flips every time a side takes; it ends as "the mover comes out at or above threshold"
+    int res = 1;
+
+    for(;;) {
+        side ^= 1;
+        attackers &= occupied;
+
+        Bitboard_t lowest;
+        PieceIndex_t piece = leastValuable(board, attackers, side, &lowest);
+        if(piece == PIECE_IDX_COUNT) break;
+
+        res ^= 1;
+
+        // the king may only take last, when nothing defends the square any more
+        if(piece == KING_IDX)
+            return (attackers & board->occupancy[side ^ 1]) ? res ^ 1 : res;
+
+        swap = PieceValues[piece] - swap;
+        if(swap < res) break;
+
+        occupied ^= lowest;
+
+        if(piece == PAWN_IDX || piece == BISHOP_IDX || piece == QUEEN_IDX)
+            attackers |= BishopAttacks(to, occupied) & diagonal;
+        if(piece == ROOK_IDX || piece == QUEEN_IDX)
+            attackers |= RookAttacks(to, occupied) & straight;
+    }
+
+    return res;
+}
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <string.h>
+#include "tablebase.h"
+#include "tb_internal.h"
+
+#define TRANSFORM_COUNT 8
+
+// transform t maps (row, col) to: bit 0 flips the columns, bit 1 flips the rows, bit 2 swaps rows and columns
+static uint8_t transforms[TRANSFORM_COUNT][SQUARE_COUNT];
+
+// per strong king square, with and without pawns: the transforms that take it into the kept squares, and its slot there
+static uint8_t king_transforms[2][SQUARE_COUNT];
+static int8_t king_slots[2][SQUARE_COUNT];
+static uint8_t slot_squares[2][SQUARE_COUNT];
+static int slot_count[2];
+
+static bool tables_ready = false;
+
+TbTable_t TbTables[TB_TABLE_COUNT];
+static int max_pieces = 0;
+
+static const char piece_letters[PIECE_IDX_COUNT] = { 'P', 'N', 'B', 'R', 'Q', 'K' };
+
+static void initIndexing(void) {
+    if(tables_ready) return;
+    InitBitboards();
+
+    for(int t = 0; t < TRANSFORM_COUNT; t++) {
+        for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+            int row = ROW_OF(sq), col = COL_OF(sq);
+            if(t & 1) col = DIM_X - 1 - col;
+            if(t & 2) row = DIM_Y - 1 - row;
+            if(t & 4) {
+                int swap = row;
+                row = col;
+                col = swap;
+            }
+            transforms[t][sq] = (uint8_t)SQUARE(row, col);
+        }
+    }
+
+    // a square is kept if no transform of the group takes it lower. pawns only allow the column flip
+    for(int pawns = 0; pawns < 2; pawns++) {
+        int group = pawns ? 2 : TRANSFORM_COUNT;
+        slot_count[pawns] = 0;
+
+        for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+            bool lowest = true;
+            for(int t = 0; t < group; t++) lowest = lowest && transforms[t][sq] >= sq;
+            king_slots[pawns][sq] = -1;
+            if(lowest) {
+                slot_squares[pawns][slot_count[pawns]] = (uint8_t)sq;
+                king_slots[pawns][sq] = (int8_t)slot_count[pawns]++;
+            }
+        }
+
+        for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+            king_transforms[pawns][sq] = 0;
+            for(int t = 0; t < group; t++) {
+                if(king_slots[pawns][transforms[t][sq]] >= 0) king_transforms[pawns][sq] |= (uint8_t)(1 << t);
+            }
+        }
+    }
+
+    tables_ready = true;
+}
+
+bool TbParseMaterial(const char* name, TbMaterial_t* material) {
+    material->count = 0;
+
+    // K, the strong pieces, K
+    size_t length = strlen(name);
+    if(length < 3 || (name[0] != 'K' && name[0] != 'k') || (name[length - 1] != 'K' && name[length - 1] != 'k'))
+        return false;
+
+    for(size_t i = 1; i < length - 1; i++) {
+        char c = name[i];
+        if(c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+
+        PieceIndex_t piece = PIECE_IDX_COUNT;
+        for(int p = PAWN_IDX; p < KING_IDX; p++) {
+            if(piece_letters[p] == c) piece = (PieceIndex_t)p;
+        }
+        if(piece == PIECE_IDX_COUNT || material->count == TB_MAX_EXTRA) return false;
+
+        // strongest first
+        int at = material->count++;
+        while(at > 0 && material->pieces[at - 1] < piece) {
+            material->pieces[at] = material->pieces[at - 1];
+            at--;
+        }
+        material->pieces[at] = piece;
+    }
+
+    return material->count > 0;
+}
+
+void TbMaterialName(const TbMaterial_t* material, char name[8]) {
+    int length = 0;
+    name[length++] = 'K';
+    for(int i = 0; i < material->count; i++) name[length++] = piece_letters[material->pieces[i]];
+    name[length++] = 'K';
+    while(length < 8) name[length++] = '\0';
+}
+
+bool TbHasPawns(const TbMaterial_t* material) {
+    for(int i = 0; i < material->count; i++) {
+        if(material->pieces[i] == PAWN_IDX) return true;
+    }
+    return false;
+}
+
+int TbTableId(const TbMaterial_t* material) {
+    // 0-4 for one piece, then every pair with the stronger piece first
+    int a = material->pieces[0];
+    if(material->count == 1) return a;
+
+    int b = material->pieces[1];
+    return PIECE_IDX_COUNT - 1 + a * (a + 1) / 2 + b;
+}
+
+size_t TbEntries(const TbMaterial_t* material) {
+    initIndexing();
+
+    size_t entries = (size_t)COLOR_IDX_COUNT * (size_t)slot_count[TbHasPawns(material)] * SQUARE_COUNT;
+    for(int i = 0; i < material->count; i++) entries *= SQUARE_COUNT;
+    return entries;
+}
+
+size_t TbIndex(const TbMaterial_t* material, const TbPosition_t* position) {
+    initIndexing();
+
+    int pawns = TbHasPawns(material);
+    bool same = material->count == 2 && material->pieces[0] == material->pieces[1];
+    size_t best = SIZE_MAX;
+
+    // the smallest index over the transforms that keep the strong king in its squares
+    for(unsigned mask = king_transforms[pawns][position->strong_king]; mask; mask &= mask - 1) {
+        const uint8_t* t = transforms[Lsb(mask)];
+
+        size_t index = (size_t)position->turn * (size_t)slot_count[pawns] + (size_t)king_slots[pawns][t[position->strong_king]];
+        index = index * SQUARE_COUNT + t[position->weak_king];
+
+        int a = t[position->pieces[0]];
+        if(material->count == 1) {
+            index = index * SQUARE_COUNT + (size_t)a;
+        } else {
+            int b = t[position->pieces[1]];
+            // two of the same piece are interchangeable, the lower square goes first
+            if(same && b < a) {
+                int swap = a;
+                a = b;
+                b = swap;
+            }
+            index = (index * SQUARE_COUNT + (size_t)a) * SQUARE_COUNT + (size_t)b;
+        }
+
+        if(index < best) best = index;
+    }
+
+    return best;
+}
+
+void TbDecode(const TbMaterial_t* material, size_t index, TbPosition_t* position) {
+    initIndexing();
+
+    int pawns = TbHasPawns(material);
+
+    for(int i = material->count - 1; i >= 0; i--) {
+        position->pieces[i] = (int)(index % SQUARE_COUNT);
+        index /= SQUARE_COUNT;
+    }
+    position->weak_king = (int)(index % SQUARE_COUNT);
+    index /= SQUARE_COUNT;
+
+    position->strong_king = slot_squares[pawns][index % (size_t)slot_count[pawns]];
+    position->turn = (ColorIndex_t)(index / (size_t)slot_count[pawns]);
+}
+
+void TbTablePath(const char* dir, const TbMaterial_t* material, char* path, size_t size) {
+    char name[8];
+    TbMaterialName(material, name);
+    snprintf(path, size, "%s/%s.tb", dir, name);
+}
+
+static void closeTable(TbTable_t* table) {
+    UnmapFile(&table->file);
+    table->values = NULL;
+    table->entries = 0;
+}
+
+bool TbMapTable(const char* dir, const TbMaterial_t* material) {
+    char path[4096];
+    TbTablePath(dir, material, path, sizeof(path));
+
+    TbTable_t* table = &TbTables[TbTableId(material)];
+    closeTable(table);
+
+    // a missing table is normal, only a damaged one is reported
+    MappedFile_t file;
+    if(!MapFile(path, &file, false)) return false;
+
+    const TbHeader_t* header = (const TbHeader_t*)file.data;
+    size_t entries = TbEntries(material);
+    char name[8];
+    TbMaterialName(material, name);
+
+    if(file.size < sizeof(TbHeader_t) || memcmp(header->magic, TB_MAGIC, sizeof(header->magic)) != 0
+        || header->version != TB_VERSION || header->value_size != 1 || memcmp(header->material, name, sizeof(name)) != 0
+        || header->entries != entries || file.size != sizeof(TbHeader_t) + entries) {
+        ERROR("%s is not a %s table", path, name);
+        UnmapFile(&file);
+        return false;
+    }
+
+    table->material = *material;
+    table->file = file;
+    table->values = file.data + sizeof(TbHeader_t);
+    table->entries = entries;
+
+    if(material->count + 2 > max_pieces) max_pieces = material->count + 2;
+    return true;
+}
+
+// every material a table can have, in TbTableId order
+static int allMaterials(TbMaterial_t* materials) {
+    int count = 0;
+    for(int a = PAWN_IDX; a < KING_IDX; a++) materials[count++] = (TbMaterial_t){ 1, { (PieceIndex_t)a, PAWN_IDX } };
+    for(int a = PAWN_IDX; a < KING_IDX; a++) {
+        for(int b = PAWN_IDX; b <= a; b++) materials[count++] = (TbMaterial_t){ 2, { (PieceIndex_t)a, (PieceIndex_t)b } };
+    }
+    return count;
+}
+
+int TbOpen(const char* dir) {
+    TbClose();
+
+    TbMaterial_t materials[TB_TABLE_COUNT];
+    int count = allMaterials(materials), found = 0;
+
+    for(int i = 0; i < count; i++) found += TbMapTable(dir, &materials[i]);
+    return found;
+}
+
+void TbClose(void) {
+    for(int i = 0; i < TB_TABLE_COUNT; i++) closeTable(&TbTables[i]);
+    max_pieces = 0;
+}
+
+int TbMaxPieces(void) {
+    return max_pieces;
+}
+
+uint8_t TbProbeValue(const TbMaterial_t* material, const TbPosition_t* position) {
+    const TbTable_t* table = &TbTables[TbTableId(material)];
+    if(!table->values) return TB_VALUE_ILLEGAL;
+
+    return table->values[TbIndex(material, position)];
+}
+
+bool TbProbe(const Board_t* board, TbResult_t* result) {
+    if(max_pieces == 0 || board->castling) return false;
+
+    Bitboard_t white = board->occupancy[WHITE_IDX], black = board->occupancy[BLACK_IDX];
+    if(PopCount(white | black) > max_pieces) return false;
+
+    // the side with more than its king is strong. both kings alone is a draw without a table
+    ColorIndex_t strong = (PopCount(white) > 1) ? WHITE_IDX : BLACK_IDX;
+    ColorIndex_t weak = (ColorIndex_t)(strong ^ 1);
+    // a defender with a piece of its own has no table, see tablebase.h
+    if(PopCount(board->occupancy[weak]) > 1) return false;
+    if(PopCount(board->occupancy[strong]) == 1) {
+        *result = (TbResult_t){ TB_DRAW, 0 };
+        return true;
+    }
+
+    // black strong: the board upside down, colors swapped, so its pawns move up like white's
+    int flip = (strong == BLACK_IDX) ? (DIM_Y - 1) * DIM_X : 0;
+
+    TbMaterial_t material = { 0, { PAWN_IDX, PAWN_IDX } };
+    TbPosition_t position;
+    position.strong_king = Lsb(board->bitboards[strong][KING_IDX]) ^ flip;
+    position.weak_king = Lsb(board->bitboards[weak][KING_IDX]) ^ flip;
+    position.turn = (ColorToIndex(board->turn) == strong) ? WHITE_IDX : BLACK_IDX;
+
+    // strongest first
+    for(int p = QUEEN_IDX; p >= PAWN_IDX; p--) {
+        Bitboard_t pieces = board->bitboards[strong][p];
+        while(pieces) {
+            material.pieces[material.count] = (PieceIndex_t)p;
+            position.pieces[material.count++] = PopLsb(&pieces) ^ flip;
+        }
+    }
+
+    uint8_t value = TbProbeValue(&material, &position);
+    if(value == TB_VALUE_ILLEGAL) return false;
+
+    if(value == TB_VALUE_DRAW) {
+        *result = (TbResult_t){ TB_DRAW, 0 };
+    } else {
+        int plies = TbValuePlies(value);
+        *result = (TbResult_t){ (plies & 1) ? TB_WIN : TB_LOSS, plies };
+    }
+    return true;
+}
@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include "tablebase.h"
+#include "tb_internal.h"
+#include "magic.h"
+
+/*
+    Retrograde generation of one table.
+
+    Every legal position starts unresolved, except mates and stalemates.
+    Round n then resolves the positions whose mate is n plies away:
+    every predecessor (a position one move earlier, found by un-moving a
+    piece of the side that just moved) of a position lost in n - 1 plies
+    is won in n, and a predecessor of a position won in n - 1 is lost in
+    n if every move it has now leads to a win for the opponent. What is
+    left when a round resolves nothing is a draw.
+
+    Captures and promotions leave the table. Their result is read from
+    the smaller table once, before the first round, and the best of them
+    for the side to move is kept per position: a win through one is
+    taken in the round of its length, unless the table has a faster one.
+
+    Each phase splits the index range between the threads. Round n only
+    writes values of n plies and only trusts those of fewer, so the
+    threads need no locks and the result doesn't depend on timing.
+*/
+
+#define MAX_GEN_THREADS 256
+#define MAX_CHILDREN 64         // moves that stay in the table: a king and two queens at most
+#define VALUE_UNKNOWN 254       // not resolved yet. also the exit of a position without captures or promotions
+
+typedef struct Generator {
+    TbMaterial_t material;
+    size_t entries;
+    _Atomic uint8_t* values;
+    uint8_t* exits;             // the side to move's best value through a capture or a promotion
+    int ply;                    // of the round running
+} Generator_t;
+
+typedef struct GenWorker {
+    Generator_t* gen;
+    size_t begin, end;
+    size_t resolved;            // this round
+    int last_exit;              // plies of the longest exit result, after the first phase
+} GenWorker_t;
+
+static inline uint8_t loadValue(const Generator_t* gen, size_t index) {
+    return atomic_load_explicit(&gen->values[index], memory_order_relaxed);
+}
+
+static inline void storeValue(Generator_t* gen, size_t index, uint8_t value) {
+    atomic_store_explicit(&gen->values[index], value, memory_order_relaxed);
+}
+
+// the value of a position for the side that moved into it
+static inline uint8_t previousValue(uint8_t value) {
+    return (value == TB_VALUE_DRAW) ? TB_VALUE_DRAW : TbPliesValue(TbValuePlies(value) + 1);
+}
+
+// higher is better for the side to move: fast wins, then draws, then slow losses
+static int preference(uint8_t value) {
+    if(value == TB_VALUE_DRAW) return 0;
+
+    int plies = TbValuePlies(value);
+    return (plies & 1) ? 1000 - plies : plies - 1000;
+}
+
+static Bitboard_t attacksOf(PieceIndex_t piece, int sq, Bitboard_t occupied) {
+    switch(piece) {
+        case PAWN_IDX:   return PawnAttacks[WHITE_IDX][sq];
+        case KNIGHT_IDX: return KnightAttacks[sq];
+        case BISHOP_IDX: return BishopAttacks(sq, occupied);
+        case ROOK_IDX:   return RookAttacks(sq, occupied);
+        case QUEEN_IDX:  return QueenAttacks(sq, occupied);
+        default:         return KingAttacks[sq];
+    }
+}
+
+static Bitboard_t occupancyOf(const TbMaterial_t* material, const TbPosition_t* position) {
+    Bitboard_t occupied = BIT(position->strong_king) | BIT(position->weak_king);
+    for(int i = 0; i < material->count; i++) occupied |= BIT(position->pieces[i]);
+    return occupied;
+}
+
+// whether the strong pieces attack sq, the one at index skip left out (-1: none)
+static bool strongAttacks(const TbMaterial_t* material, const TbPosition_t* position, int sq, Bitboard_t occupied, int skip) {
+    if(KingAttacks[position->strong_king] & BIT(sq)) return true;
+
+    for(int i = 0; i < material->count; i++) {
+        if(i != skip && (attacksOf(material->pieces[i], position->pieces[i], occupied) & BIT(sq))) return true;
+    }
+    return false;
+}
+
+static bool isLegal(const TbMaterial_t* material, const TbPosition_t* position) {
+    Bitboard_t occupied = BIT(position->strong_king);
+    if(occupied & BIT(position->weak_king)) return false;
+    occupied |= BIT(position->weak_king);
+
+    for(int i = 0; i < material->count; i++) {
+        int sq = position->pieces[i];
+        if(occupied & BIT(sq)) return false;
+        if(material->pieces[i] == PAWN_IDX && (ROW_OF(sq) == 0 || ROW_OF(sq) == DIM_Y - 1)) return false;
+        occupied |= BIT(sq);
+    }
+
+    if(KingAttacks[position->strong_king] & BIT(position->weak_king)) return false;
+
+    // the weak king can't be in check with the strong side to move
+    return position->turn == BLACK_IDX || !strongAttacks(material, position, position->weak_king, occupied, -1);
+}
+
+// the moves that stay in the table, as the positions they lead to
+static int tableMoves(const TbMaterial_t* material, const TbPosition_t* position, TbPosition_t* children) {
+    Bitboard_t occupied = occupancyOf(material, position);
+    int count = 0;
+
+    if(position->turn == BLACK_IDX) {
+        // the lone king: off the squares the strong side covers, seen through where it stands now
+        Bitboard_t targets = KingAttacks[position->weak_king] & ~occupied & ~KingAttacks[position->strong_king];
+        Bitboard_t through = occupied ^ BIT(position->weak_king);
+
+        while(targets) {
+            int to = PopLsb(&targets);
+            if(strongAttacks(material, position, to, through, -1)) continue;
+
+            children[count] = *position;
+            children[count].weak_king = to;
+            children[count++].turn = WHITE_IDX;
+        }
+        return count;
+    }
+
+    Bitboard_t targets = KingAttacks[position->strong_king] & ~occupied & ~KingAttacks[position->weak_king];
+    while(targets) {
+        children[count] = *position;
+        children[count].strong_king = PopLsb(&targets);
+        children[count++].turn = BLACK_IDX;
+    }
+
+    for(int i = 0; i < material->count; i++) {
+        int from = position->pieces[i];
+
+        if(material->pieces[i] == PAWN_IDX) {
+            // pushes only, there is nothing to capture but the king. reaching row 0 promotes and leaves the table
+            targets = 0;
+            if(ROW_OF(from) > 1 && !(occupied & BIT(from - DIM_X))) {
+                targets |= BIT(from - DIM_X);
+                if(ROW_OF(from) == DIM_Y - 2 && !(occupied & BIT(from - 2 * DIM_X))) targets |= BIT(from - 2 * DIM_X);
+            }
+        } else {
+            targets = attacksOf(material->pieces[i], from, occupied) & ~occupied;
+        }
+
+        while(targets) {
+            children[count] = *position;
+            children[count].pieces[i] = PopLsb(&targets);
+            children[count++].turn = BLACK_IDX;
+        }
+    }
+
+    return count;
+}
+
+// the positions one move earlier: a piece of the side that just moved goes back to where it came from
+static int previousPositions(const TbMaterial_t* material, const TbPosition_t* position, TbPosition_t* parents) {
+    Bitboard_t occupied = occupancyOf(material, position);
+    int count = 0;
+
+    if(position->turn == WHITE_IDX) {
+        Bitboard_t from = KingAttacks[position->weak_king] & ~occupied;
+        while(from) {
+            parents[count] = *position;
+            parents[count].weak_king = PopLsb(&from);
+            parents[count++].turn = BLACK_IDX;
+        }
+        return count;
+    }
+
+    Bitboard_t from = KingAttacks[position->strong_king] & ~occupied;
+    while(from) {
+        parents[count] = *position;
+        parents[count].strong_king = PopLsb(&from);
+        parents[count++].turn = WHITE_IDX;
+    }
+
+    for(int i = 0; i < material->count; i++) {
+        int to = position->pieces[i];
+
+        if(material->pieces[i] == PAWN_IDX) {
+            // one square back, not onto row 7, or two from the starting row
+            from = 0;
+            if(ROW_OF(to) < DIM_Y - 2 && !(occupied & BIT(to + DIM_X))) {
+                from |= BIT(to + DIM_X);
+                if(ROW_OF(to) == DIM_Y - 4 && !(occupied & BIT(to + 2 * DIM_X))) from |= BIT(to + 2 * DIM_X);
+            }
+        } else {
+            from = attacksOf(material->pieces[i], to, occupied) & ~occupied;
+        }
+
+        while(from) {
+            parents[count] = *position;
+            parents[count].pieces[i] = PopLsb(&from);
+            parents[count++].turn = WHITE_IDX;
+        }
+    }
+
+    return count;
+}
+
+// position with piece i taken off, or turned into promoted. the result is sorted strongest first again
+static void changeMaterial(const TbMaterial_t* material, const TbPosition_t* position, int i, PieceIndex_t promoted,
+                           TbMaterial_t* to_material, TbPosition_t* to_position) {
+    *to_position = *position;
+    to_material->count = 0;
+
+    for(int j = 0; j < material->count; j++) {
+        PieceIndex_t piece = material->pieces[j];
+        if(j == i) {
+            if(promoted == PIECE_IDX_COUNT) continue;
+            piece = promoted;
+        }
+
+        int at = to_material->count++;
+        while(at > 0 && to_material->pieces[at - 1] < piece) {
+            to_material->pieces[at] = to_material->pieces[at - 1];
+            to_position->pieces[at] = to_position->pieces[at - 1];
+            at--;
+        }
+        to_material->pieces[at] = piece;
+        to_position->pieces[at] = position->pieces[j];
+    }
+}
+
+// the best value for the side to move through captures and promotions, VALUE_UNKNOWN if it has none.
+// the smaller tables are mapped by then
+static uint8_t exitValue(const TbMaterial_t* material, const TbPosition_t* position) {
+    Bitboard_t occupied = occupancyOf(material, position);
+    uint8_t best = VALUE_UNKNOWN;
+    TbMaterial_t next_material;
+    TbPosition_t next;
+
+    for(int i = 0; i < material->count; i++) {
+        int sq = position->pieces[i];
+        uint8_t value;
+
+        if(position->turn == BLACK_IDX) {
+            // the king takes an undefended piece
+            if(!(KingAttacks[position->weak_king] & BIT(sq)) || strongAttacks(material, position, sq, occupied ^ BIT(position->weak_king), i))
+                continue;
+
+            changeMaterial(material, position, i, PIECE_IDX_COUNT, &next_material, &next);
+            next.weak_king = sq;
+            next.turn = WHITE_IDX;
+            value = (next_material.count == 0) ? TB_VALUE_DRAW : previousValue(TbProbeValue(&next_material, &next));
+            if(best == VALUE_UNKNOWN || preference(value) > preference(best)) best = value;
+        } else if(material->pieces[i] == PAWN_IDX && ROW_OF(sq) == 1 && !(occupied & BIT(sq - DIM_X))) {
+            for(int promoted = QUEEN_IDX; promoted >= KNIGHT_IDX; promoted--) {
+                changeMaterial(material, position, i, (PieceIndex_t)promoted, &next_material, &next);
+                for(int j = 0; j < next_material.count; j++) {
+                    if(next.pieces[j] == sq) next.pieces[j] = sq - DIM_X;
+                }
+                next.turn = BLACK_IDX;
+
+                value = previousValue(TbProbeValue(&next_material, &next));
+                if(best == VALUE_UNKNOWN || preference(value) > preference(best)) best = value;
+            }
+        }
+    }
+
+    return best;
+}
+
+// every move of the position at index leads to a win for the opponent in fewer than ply plies,
+// and no capture or promotion holds out longer than ply
+static bool isLost(const Generator_t* gen, const TbPosition_t* position, size_t index, int ply) {
+    uint8_t exit = gen->exits[index];
+    if(exit != VALUE_UNKNOWN && (exit == TB_VALUE_DRAW || (TbValuePlies(exit) & 1) || TbValuePlies(exit) > ply))
+        return false;
+
+    TbPosition_t children[MAX_CHILDREN];
+    int count = tableMoves(&gen->material, position, children);
+
+    for(int i = 0; i < count; i++) {
+        uint8_t value = loadValue(gen, TbIndex(&gen->material, &children[i]));
+        if(value == VALUE_UNKNOWN || value == TB_VALUE_DRAW) return false;
+
+        int plies = TbValuePlies(value);
+        if(!(plies & 1) || plies >= ply) return false;
+    }
+
+    return true;
+}
+
+static int initChunk(void* data) {
+    GenWorker_t* worker = data;
+    Generator_t* gen = worker->gen;
+    const TbMaterial_t* material = &gen->material;
+    TbPosition_t position, children[MAX_CHILDREN];
+
+    worker->last_exit = 0;
+
+    for(size_t index = worker->begin; index < worker->end; index++) {
+        gen->exits[index] = VALUE_UNKNOWN;
+
+        // mirror images are left to the index that stands for them
+        TbDecode(material, index, &position);
+        if(!isLegal(material, &position) || TbIndex(material, &position) != index) {
+            storeValue(gen, index, TB_VALUE_ILLEGAL);
+            continue;
+        }
+
+        uint8_t exit = exitValue(material, &position);
+        gen->exits[index] = exit;
+        if(exit != VALUE_UNKNOWN && exit != TB_VALUE_DRAW && TbValuePlies(exit) > worker->last_exit)
+            worker->last_exit = TbValuePlies(exit);
+
+        uint8_t value = VALUE_UNKNOWN;
+        if(exit == VALUE_UNKNOWN && tableMoves(material, &position, children) == 0) {
+            // only the weak king can be in check
+            bool in_check = position.turn == BLACK_IDX
+                && strongAttacks(material, &position, position.weak_king, occupancyOf(material, &position), -1);
+            value = in_check ? TbPliesValue(0) : TB_VALUE_DRAW;
+        }
+        storeValue(gen, index, value);
+    }
+
+    return 0;
+}
+
+static int roundChunk(void* data) {
+    GenWorker_t* worker = data;
+    Generator_t* gen = worker->gen;
+    const TbMaterial_t* material = &gen->material;
+    int ply = gen->ply;
+    uint8_t previous = TbPliesValue(ply - 1), target = TbPliesValue(ply);
+    bool win = ply & 1;
+    TbPosition_t position, parents[MAX_CHILDREN * 2];
+
+    worker->resolved = 0;
+
+    for(size_t index = worker->begin; index < worker->end; index++) {
+        uint8_t value = loadValue(gen, index);
+
+        if(value == previous) {
+            TbDecode(material, index, &position);
+            int count = previousPositions(material, &position, parents);
+
+            for(int i = 0; i < count; i++) {
+                size_t parent = TbIndex(material, &parents[i]);
+                if(loadValue(gen, parent) != VALUE_UNKNOWN) continue;
+
+                // illegal parents are never unknown, so they are skipped above
+                if(win || isLost(gen, &parents[i], parent, ply)) {
+                    storeValue(gen, parent, target);
+                    worker->resolved++;
+                }
+            }
+        } else if(value == VALUE_UNKNOWN && gen->exits[index] == target) {
+            // the capture or promotion is as fast a win, or as long a loss, as anything left
+            TbDecode(material, index, &position);
+            if(win || isLost(gen, &position, index, ply)) {
+                storeValue(gen, index, target);
+                worker->resolved++;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void runPhase(GenWorker_t* workers, int threads, thrd_start_t phase) {
+    thrd_t handles[MAX_GEN_THREADS];
+    bool started[MAX_GEN_THREADS] = { false };
+
+    for(int i = 1; i < threads; i++)
+        started[i] = thrd_create(&handles[i], phase, &workers[i]) == thrd_success;
+
+    phase(&workers[0]);
+
+    for(int i = 1; i < threads; i++) {
+        if(started[i]) thrd_join(handles[i], NULL);
+        else phase(&workers[i]);
+    }
+}
+
+static bool writeTable(const char* dir, const Generator_t* gen) {
+    char path[4096];
+    TbTablePath(dir, &gen->material, path, sizeof(path));
+
+    FILE* file = fopen(path, "wb");
+    if(!file) {
+        ERROR("Failed to create %s", path);
+        return false;
+    }
+
+    TbHeader_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TB_MAGIC, sizeof(header.magic));
+    header.version = TB_VERSION;
+    header.value_size = 1;
+    TbMaterialName(&gen->material, header.material);
+    header.entries = gen->entries;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    uint8_t buffer[1 << 16];
+    for(size_t at = 0; ok && at < gen->entries; ) {
+        size_t count = gen->entries - at < sizeof(buffer) ? gen->entries - at : sizeof(buffer);
+        for(size_t i = 0; i < count; i++) buffer[i] = loadValue(gen, at + i);
+
+        ok = fwrite(buffer, 1, count, file) == count;
+        at += count;
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    if(!ok) ERROR("Failed to write %s", path);
+    return ok;
+}
+
+static bool generateTable(const char* dir, const TbMaterial_t* material, int threads, TbGenStats_t* stats) {
+    Generator_t gen;
+    gen.material = *material;
+    gen.entries = TbEntries(material);
+    gen.values = malloc(gen.entries * sizeof(*gen.values));
+    gen.exits = malloc(gen.entries);
+
+    char name[8];
+    TbMaterialName(material, name);
+
+    GenWorker_t* workers = malloc((size_t)threads * sizeof(GenWorker_t));
+    if(!gen.values || !gen.exits || !workers) {
+        ERROR("Out of memory for the %s table", name);
+        free((void*)gen.values);
+        free(gen.exits);
+        free(workers);
+        return false;
+    }
+
+    for(int i = 0; i < threads; i++) {
+        workers[i].gen = &gen;
+        workers[i].begin = gen.entries * (size_t)i / (size_t)threads;
+        workers[i].end = gen.entries * (size_t)(i + 1) / (size_t)threads;
+    }
+
+    runPhase(workers, threads, initChunk);
+
+    int last_exit = 0;
+    for(int i = 0; i < threads; i++) {
+        if(workers[i].last_exit > last_exit) last_exit = workers[i].last_exit;
+    }
+
+    // until a round resolves nothing and no exit is still to come
+    bool ok = true;
+    for(gen.ply = 1; ; gen.ply++) {
+        if(gen.ply > TB_MAX_PLIES) {
+            ERROR("%s has mates longer than %d plies", name, TB_MAX_PLIES);
+            ok = false;
+            break;
+        }
+
+        runPhase(workers, threads, roundChunk);
+
+        size_t resolved = 0;
+        for(int i = 0; i < threads; i++) resolved += workers[i].resolved;
+        if(resolved == 0 && gen.ply >= last_exit) break;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->entries = gen.entries;
+
+    for(size_t index = 0; ok && index < gen.entries; index++) {
+        uint8_t value = loadValue(&gen, index);
+        if(value == TB_VALUE_ILLEGAL) continue;
+
+        if(value == VALUE_UNKNOWN || value == TB_VALUE_DRAW) {
+            storeValue(&gen, index, TB_VALUE_DRAW);
+            stats->draws++;
+        } else if(TbValuePlies(value) & 1) {
+            stats->wins++;
+        } else {
+            stats->losses++;
+        }
+
+        if(value != VALUE_UNKNOWN && value != TB_VALUE_DRAW && TbValuePlies(value) > stats->longest)
+            stats->longest = TbValuePlies(value);
+    }
+
+    ok = ok && writeTable(dir, &gen);
+
+    free((void*)gen.values);
+    free(gen.exits);
+    free(workers);
+
+    return ok && TbMapTable(dir, material);
+}
+
+bool TbGenerate(const char* dir, const TbMaterial_t* material, int threads, TbGenStats_t* stats) {
+    if(threads < 1) threads = 1;
+    if(threads > MAX_GEN_THREADS) threads = MAX_GEN_THREADS;
+
+    // the tables captures and promotions lead to, from dir or generated now
+    TbMaterial_t next[TB_MAX_EXTRA * 4];
+    int count = 0;
+    TbPosition_t unused = { 0 }, ignored;
+
+    for(int i = 0; i < material->count; i++) {
+        if(material->count > 1) changeMaterial(material, &unused, i, PIECE_IDX_COUNT, &next[count++], &ignored);
+
+        if(material->pieces[i] == PAWN_IDX) {
+            for(int promoted = QUEEN_IDX; promoted >= KNIGHT_IDX; promoted--)
+                changeMaterial(material, &unused, i, (PieceIndex_t)promoted, &next[count++], &ignored);
+        }
+    }
+
+    int tables = 0;
+    for(int i = 0; i < count; i++) {
+        if(TbTables[TbTableId(&next[i])].values || TbMapTable(dir, &next[i])) continue;
+
+        if(!TbGenerate(dir, &next[i], threads, stats)) return false;
+        tables += stats->tables;
+    }
+
+    if(!generateTable(dir, material, threads, stats)) return false;
+    stats->tables = tables + 1;
+    return true;
+}
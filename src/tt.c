@@ -0,0 +1,189 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "tt.h"
+#include "setting.h"
+
+#define CACHE_LINE 64
+
+/*
+    data word layout:
+    bits  0-15  move
+    bits 16-31  score (int16)
+    bits 32-39  depth (int8)
+    bits 40-41  bound
+    bits 42-47  age of the search that stored it
+*/
+#define AGE_BITS 6
+#define AGE_MASK ((1 << AGE_BITS) - 1)
+
+typedef struct TTEntry {
+    _Atomic uint64_t check; // key ^ data
+    _Atomic uint64_t data;
+} TTEntry_t;
+
+typedef struct TTBucket {
+    TTEntry_t entries[TT_BUCKET_SIZE];
+} TTBucket_t;
+
+_Static_assert(sizeof(TTBucket_t) == CACHE_LINE, "a bucket must fill exactly one cache line");
+
+static TTBucket_t* table = NULL;
+static uint64_t bucket_mask = 0; // bucket count - 1
+static size_t table_mb = 0;
+static int current_age = 0;
+
+// probed before the first TTResize, so callers never see NULL
+static TTBucket_t empty_bucket;
+
+static void* allocAligned(size_t size) {
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, CACHE_LINE);
+#else
+    return aligned_alloc(CACHE_LINE, size);
+#endif
+}
+
+static void freeAligned(void* ptr) {
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+static inline uint64_t pack(PackedMove_t move, int score, int depth, TTBound_t bound, int age) {
+    return (uint64_t)move
+         | (uint64_t)(uint16_t)(int16_t)score << 16
+         | (uint64_t)(uint8_t)(int8_t)depth << 32
+         | (uint64_t)bound << 40
+         | (uint64_t)age << 42;
+}
+
+static inline PackedMove_t dataMove(uint64_t data) { return (PackedMove_t)(data & 0xFFFF); }
+static inline int dataScore(uint64_t data) { return (int16_t)((data >> 16) & 0xFFFF); }
+static inline int dataDepth(uint64_t data) { return (int8_t)((data >> 32) & 0xFF); }
+static inline TTBound_t dataBound(uint64_t data) { return (TTBound_t)((data >> 40) & 3); }
+static inline int dataAge(uint64_t data) { return (int)((data >> 42) & AGE_MASK); }
+
+static inline TTBucket_t* bucketFor(uint64_t key) {
+    return table ? &table[key & bucket_mask] : &empty_bucket;
+}
+
+bool TTResize(size_t mb) {
+    if(mb < 1) mb = 1;
+
+    uint64_t buckets = 1;
+    while(buckets * 2 * sizeof(TTBucket_t) <= (uint64_t)mb * 1024 * 1024)
+        buckets *= 2;
+
+    TTBucket_t* resized = allocAligned(buckets * sizeof(TTBucket_t));
+    if(!resized) {
+        ERROR("Failed to allocate a %zu MB transposition table", mb);
+        return false;
+    }
+
+    freeAligned(table);
+    table = resized;
+    bucket_mask = buckets - 1;
+    table_mb = (buckets * sizeof(TTBucket_t)) >> 20;
+
+    TTClear();
+    return true;
+}
+
+void TTFree(void) {
+    freeAligned(table);
+    table = NULL;
+    bucket_mask = 0;
+    table_mb = 0;
+}
+
+void TTClear(void) {
+    if(table) memset(table, 0, (bucket_mask + 1) * sizeof(TTBucket_t));
+    current_age = 0;
+}
+
+size_t TTSizeMB(void) {
+    return table_mb;
+}
+
+void TTNewSearch(void) {
+    current_age = (current_age + 1) & AGE_MASK;
+}
+
+const void* TTBucketAddress(uint64_t key) {
+    return bucketFor(key);
+}
+
+bool TTProbe(uint64_t key, TTData_t* out) {
+    TTEntry_t* entries = bucketFor(key)->entries;
+
+    for(int i = 0; i < TT_BUCKET_SIZE; i++) {
+        uint64_t data = atomic_load_explicit(&entries[i].data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&entries[i].check, memory_order_relaxed);
+
+        // torn or foreign entries fail this
+        if((check ^ data) != key || data == 0) continue;
+
+        out->move = dataMove(data);
+        out->score = dataScore(data);
+        out->depth = dataDepth(data);
+        out->bound = dataBound(data);
+        return true;
+    }
+
+    return false;
+}
+
+void TTStore(uint64_t key, PackedMove_t move, int score, int depth, TTBound_t bound) {
+    if(!table) return;
+
+    TTEntry_t* entries = bucketFor(key)->entries;
+    TTEntry_t* replace = &entries[0];
+    int worst = INT32_MAX;
+
+    for(int i = 0; i < TT_BUCKET_SIZE; i++) {
+        uint64_t data = atomic_load_explicit(&entries[i].data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&entries[i].check, memory_order_relaxed);
+
+        if((check ^ data) == key) {
+            // don't let a shallow result without a move erase what we know
+            if(move == NO_MOVE) move = dataMove(data);
+            if(bound != TT_BOUND_EXACT && depth < dataDepth(data) - 2 && dataAge(data) == current_age)
+                return;
+
+            replace = &entries[i];
+            break;
+        }
+
+        // prefer empty, then stale, then shallow entries
+        int age_gap = (current_age - dataAge(data)) & AGE_MASK;
+        int value = (data == 0) ? INT32_MIN : dataDepth(data) - 8 * age_gap;
+
+        if(value < worst) {
+            worst = value;
+            replace = &entries[i];
+        }
+    }
+
+    uint64_t data = pack(move, score, depth, bound, current_age);
+    atomic_store_explicit(&replace->data, data, memory_order_relaxed);
+    atomic_store_explicit(&replace->check, key ^ data, memory_order_relaxed);
+}
+
+int TTHashfull(void) {
+    if(!table) return 0;
+
+    uint64_t sample = (bucket_mask + 1 < 250) ? bucket_mask + 1 : 250;
+    int used = 0;
+
+    for(uint64_t b = 0; b < sample; b++) {
+        for(int i = 0; i < TT_BUCKET_SIZE; i++) {
+            uint64_t data = atomic_load_explicit(&table[b].entries[i].data, memory_order_relaxed);
+            if(data != 0 && dataAge(data) == current_age) used++;
+        }
+    }
+
+    return (int)(used * 1000 / (sample * TT_BUCKET_SIZE));
+}
@@ -0,0 +1,82 @@
+#include "zobrist.h"
+#include "board.h"
+
+uint64_t ZobristPieces[COLOR_IDX_COUNT][PIECE_IDX_COUNT][SQUARE_COUNT];
+uint64_t ZobristCastling[16];
+uint64_t ZobristEnPassant[DIM_X];
+uint64_t ZobristSide;
+
+static bool initialized = false;
+
+// xorshift64*, fixed seed so keys are the same on every run
+static uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+void InitZobrist(void) {
+    if(initialized) return;
+
+    uint64_t state = 1070372ULL;
+
+    for(int c = 0; c < COLOR_IDX_COUNT; c++)
+        for(int p = 0; p < PIECE_IDX_COUNT; p++)
+            for(int sq = 0; sq < SQUARE_COUNT; sq++)
+                ZobristPieces[c][p][sq] = NextRandom(&state);
+
+    // one key per combination of rights, so a whole rights change is a single XOR
+    for(int i = 0; i < 16; i++)
+        ZobristCastling[i] = NextRandom(&state);
+
+    for(int i = 0; i < DIM_X; i++)
+        ZobristEnPassant[i] = NextRandom(&state);
+
+    ZobristSide = NextRandom(&state);
+
+    initialized = true;
+}
+
+bool EnPassantCapturable(const Board_t* board) {
+    if(board->ep_square == NO_SQUARE) return false;
+
+    ColorIndex_t us = ColorToIndex(board->turn);
+
+    // our pawns that could capture onto the square are the ones it "attacks" as an enemy pawn
+    return (PawnAttacks[us ^ 1][board->ep_square] & board->bitboards[us][PAWN_IDX]) != 0;
+}
+
+uint64_t ComputeKey(const Board_t* board) {
+    uint64_t key = 0;
+
+    for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+        for(int p = 0; p < PIECE_IDX_COUNT; p++) {
+            Bitboard_t pieces = board->bitboards[c][p];
+            while(pieces)
+                key ^= ZobristPieces[c][p][PopLsb(&pieces)];
+        }
+    }
+
+    key ^= ZobristCastling[board->castling];
+
+    if(EnPassantCapturable(board))
+        key ^= ZobristEnPassant[COL_OF(board->ep_square)];
+
+    if(board->turn == BLACK)
+        key ^= ZobristSide;
+
+    return key;
+}
+
+uint64_t ComputePawnKey(const Board_t* board) {
+    uint64_t key = 0;
+
+    for(int c = 0; c < COLOR_IDX_COUNT; c++) {
+        Bitboard_t pawns = board->bitboards[c][PAWN_IDX];
+        while(pawns)
+            key ^= ZobristPieces[c][PAWN_IDX][PopLsb(&pawns)];
+    }
+
+    return key;
+}
@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+#include "search.h"
+#include "tt.h"
+#include "evaluate.h"
+#include "timer.h"
+#include "nnue.h"
+#include "epd.h"
+
+/*
+    Fixed depth search over a fixed set of positions, so engine changes
+    can be compared by node count (must not change for pure speedups)
+    and by nodes/sec.
+
+    bench [depth] [hash_mb] [threads] [nnue]
+                                        default depth 5, 16 MB table, 1 thread, psq evaluation
+    bench --smp [depth]                 time to depth and nodes/sec at 1/2/4/8/16 threads
+    bench --eval [depth]                static evaluations/sec, default depth 3
+    bench --nnue <file> [depth]         network updates and evaluations/sec per kernel, default depth 3
+    bench --epd <file> [threads]        EPD positions loaded/sec at 1, 2, 4... up to threads
+
+    The table is cleared before every position so single thread runs are
+    repeatable. With more threads node counts vary from run to run.
+*/
+
+static const char* positions[] = {
+    STARTING_POSITION,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+    "2rq1rk1/pb2bppp/1pn1pn2/2pp4/2PP4/1PN1PN2/PB2BPPP/2RQ1RK1 w - - 0 11",
+    "r2q1rk1/1b1nbppp/p2ppn2/1p6/3NP3/1BN1B3/PPP1QPPP/R4RK1 w - - 0 11",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "8/pp3k2/2p1p3/3pP1p1/3P2P1/2P2K2/PP6/8 w - - 0 1",
+    "3r2k1/pp3ppp/2n5/8/3N4/8/PP3PPP/3R2K1 w - - 0 1",
+};
+
+typedef struct BenchResult {
+    uint64_t nodes;
+    uint64_t pawn_probes;
+    uint64_t pawn_hits;
+    int64_t search_ms; // sum of the time to depth of every position
+} BenchResult_t;
+
+// a typo in positions[] would otherwise bench the starting position instead. InitBoardFromFen says which one
+static void loadPosition(Board_t* board, size_t i) {
+    if(!InitBoardFromFen(board, positions[i])) exit(1);
+}
+
+static BenchResult_t runPositions(int depth, bool verbose) {
+    static Board_t board;
+    BenchResult_t total = { 0 };
+
+    size_t count = sizeof(positions) / sizeof(positions[0]);
+
+    for(size_t i = 0; i < count; i++) {
+        loadPosition(&board, i);
+        TTClear();
+
+        SearchLimits_t limits = { 0 };
+        limits.depth = depth;
+
+        int64_t start = NowMs();
+        SearchResult_t result = SearchPosition(&board, &limits);
+        int64_t elapsed = NowMs() - start;
+
+        if(verbose) {
+            char name[6] = "none";
+            if(result.best_move != NO_MOVE) MoveToString(result.best_move, name);
+
+            printf("%2zu: %-5s score %6d  nodes %10llu  %6lld ms\n", i + 1, name, result.score,
+                   (unsigned long long)result.nodes, (long long)elapsed);
+        }
+
+        total.nodes += result.nodes;
+        total.pawn_probes += result.pawn_probes;
+        total.pawn_hits += result.pawn_hits;
+        total.search_ms += elapsed;
+    }
+
+    return total;
+}
+
+static uint64_t nps(BenchResult_t result) {
+    return result.nodes * 1000 / (uint64_t)(result.search_ms > 0 ? result.search_ms : 1);
+}
+
+// time to depth and nodes/sec of the whole set at 1, 2, 4, 8 and 16 threads
+static int runScaling(int depth) {
+    static const int thread_counts[] = { 1, 2, 4, 8, 16 };
+    BenchResult_t single = { 0 };
+
+    printf("threads  time to depth       nodes          nps  speedup  nps scaling\n");
+
+    for(size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        if(!SetSearchThreads(thread_counts[i])) return 1;
+
+        BenchResult_t result = runPositions(depth, false);
+        if(i == 0) single = result;
+
+        printf("%7d  %10lld ms  %10llu  %11llu  %6.2fx  %10.2fx\n", GetSearchThreads(),
+               (long long)result.search_ms, (unsigned long long)result.nodes,
+               (unsigned long long)nps(result),
+               (double)single.search_ms / (double)(result.search_ms > 0 ? result.search_ms : 1),
+               (double)nps(result) / (double)(nps(single) > 0 ? nps(single) : 1));
+    }
+
+    FreeSearchThreads();
+    NnueUnload();
+    return 0;
+}
+
+#define EVAL_REPEAT 64
+
+static volatile int eval_sink;
+
+static PawnTable_t eval_pawns;
+
+// walks the tree and evaluates every leaf EVAL_REPEAT times, so the walk itself barely counts
+static uint64_t evalLeaves(Board_t* board, int depth) {
+    if(depth == 0) {
+        int sum = 0;
+        for(int i = 0; i < EVAL_REPEAT; i++)
+            sum += Evaluate(board, &eval_pawns);
+        eval_sink = sum;
+        return EVAL_REPEAT;
+    }
+
+    MoveList_t list;
+    list.size = 0;
+    GenerateMoves(board, &list);
+
+    uint64_t evals = 0;
+    for(size_t i = 0; i < list.size; i++) {
+        UndoInfo_t undo;
+        MakeMove(board, list.moves[i], &undo);
+        evals += evalLeaves(board, depth - 1);
+        UnmakeMove(board, &undo);
+    }
+
+    return evals;
+}
+
+static int runEval(int depth) {
+    static Board_t board;
+    uint64_t evals = 0;
+    double start = NowSeconds();
+
+    for(size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+        loadPosition(&board, i);
+        evals += evalLeaves(&board, depth);
+    }
+
+    double elapsed = NowSeconds() - start;
+
+    printf("Evals: %llu\n", (unsigned long long)evals);
+    printf("Time: %.3f s\n", elapsed);
+    printf("Evals/sec: %.0f\n", elapsed > 0 ? evals / elapsed : 0.0);
+    return 0;
+}
+
+typedef struct NnueWalk {
+    Accumulator_t acc[MAX_PLY + 1];
+    uint64_t nodes;
+    uint64_t mismatches;
+    bool refresh; // recompute every node instead of updating from the parent
+    bool verify;  // compare the incremental accumulator with a refresh
+} NnueWalk_t;
+
+// the search's pattern: one update and one evaluation per node
+static void nnueLeaves(NnueWalk_t* walk, Board_t* board, int ply, int depth) {
+    eval_sink = NnueEvaluate(&walk->acc[ply], board->turn);
+    walk->nodes++;
+
+    if(walk->verify) {
+        static Accumulator_t fresh;
+        NnueRefresh(&fresh, board);
+        if(memcmp(&fresh, &walk->acc[ply], sizeof(fresh)) != 0) walk->mismatches++;
+    }
+
+    if(depth == 0) return;
+
+    MoveList_t list;
+    list.size = 0;
+    GenerateMoves(board, &list);
+
+    for(size_t i = 0; i < list.size; i++) {
+        UndoInfo_t undo;
+        MakeMove(board, list.moves[i], &undo);
+
+        if(walk->refresh) NnueRefresh(&walk->acc[ply + 1], board);
+        else NnueUpdate(&walk->acc[ply + 1], &walk->acc[ply], &undo);
+
+        nnueLeaves(walk, board, ply + 1, depth - 1);
+        UnmakeMove(board, &undo);
+    }
+}
+
+static double nnueRun(NnueWalk_t* walk, int depth) {
+    static Board_t board;
+    walk->nodes = walk->mismatches = 0;
+    double start = NowSeconds();
+
+    for(size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+        loadPosition(&board, i);
+        NnueRefresh(&walk->acc[0], &board);
+        nnueLeaves(walk, &board, 0, depth);
+    }
+
+    double elapsed = NowSeconds() - start;
+    return elapsed > 0 ? walk->nodes / elapsed : 0.0;
+}
+
+static int runNnue(const char* path, int depth) {
+    if(!NnueLoad(path)) return 1;
+
+    static NnueWalk_t walk;
+    NnueKernel_t best = NnueCurrentKernel();
+
+    walk.verify = true;
+    nnueRun(&walk, depth);
+    printf("Nodes: %llu, incremental vs refresh mismatches: %llu\n\n",
+           (unsigned long long)walk.nodes, (unsigned long long)walk.mismatches);
+    walk.verify = false;
+
+    printf("%-8s %16s %16s\n", "kernel", "updates/sec", "refreshes/sec");
+    for(int k = 0; k < NNUE_KERNEL_COUNT; k++) {
+        if(!NnueSelectKernel((NnueKernel_t)k)) continue;
+
+        walk.refresh = false;
+        double updates = nnueRun(&walk, depth);
+        walk.refresh = true;
+        double refreshes = nnueRun(&walk, depth);
+
+        printf("%-8s %16.0f %16.0f\n", NnueKernelName((NnueKernel_t)k), updates, refreshes);
+    }
+
+    NnueSelectKernel(best);
+    NnueUnload();
+    return walk.mismatches != 0;
+}
+
+static int runEpd(const char* path, int max_threads) {
+    printf("%-8s %12s %10s %10s %16s\n", "threads", "positions", "rejected", "time", "positions/sec");
+
+    for(int threads = 1; ; threads *= 2) {
+        if(threads > max_threads) threads = max_threads;
+
+        EpdSet_t set;
+        double start = NowSeconds();
+        if(!LoadEpdFile(path, threads, &set)) return 1;
+        double elapsed = NowSeconds() - start;
+
+        printf("%-8d %12zu %10zu %9.3fs %16.0f\n", threads, set.count, set.rejected, elapsed,
+               elapsed > 0 ? set.count / elapsed : 0.0);
+        FreeEpdSet(&set);
+
+        if(threads == max_threads) break;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc > 1 && strcmp(argv[1], "--smp") == 0) {
+        int depth = (argc > 2) ? atoi(argv[2]) : 6;
+        if(depth < 1 || !TTResize(TT_DEFAULT_MB)) return 1;
+
+        return runScaling(depth);
+    }
+
+    if(argc > 1 && strcmp(argv[1], "--eval") == 0) {
+        int depth = (argc > 2) ? atoi(argv[2]) : 3;
+        if(depth < 0) return 1;
+
+        return runEval(depth);
+    }
+
+    if(argc > 2 && strcmp(argv[1], "--nnue") == 0) {
+        int depth = (argc > 3) ? atoi(argv[3]) : 3;
+        if(depth < 0 || depth >= MAX_PLY) return 1;
+
+        return runNnue(argv[2], depth);
+    }
+
+    if(argc > 2 && strcmp(argv[1], "--epd") == 0) {
+        int threads = (argc > 3) ? atoi(argv[3]) : 1;
+        if(threads < 1) return 1;
+
+        return runEpd(argv[2], threads);
+    }
+
+    int depth = (argc > 1) ? atoi(argv[1]) : 5;
+    int hash_mb = (argc > 2) ? atoi(argv[2]) : TT_DEFAULT_MB;
+    int threads = (argc > 3) ? atoi(argv[3]) : 1;
+    if(depth < 1 || hash_mb < 1 || threads < 1) {
+        fprintf(stderr, "usage: %s [depth] [hash_mb] [threads] [nnue]\n       %s --smp [depth]\n       %s --eval [depth]\n"
+                "       %s --nnue <file> [depth]\n       %s --epd <file> [threads]\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    if(!TTResize((size_t)hash_mb) || !SetSearchThreads(threads)) return 1;
+    if(argc > 4 && !NnueLoad(argv[4])) return 1;
+
+    BenchResult_t result = runPositions(depth, true);
+
+    printf("\n");
+    printf("Nodes: %llu\n", (unsigned long long)result.nodes);
+    printf("Time: %.3f s\n", result.search_ms / 1000.0);
+    printf("NPS: %llu\n", (unsigned long long)nps(result));
+    if(result.pawn_probes)
+        printf("Pawn table hits: %.1f%%\n", 100.0 * (double)result.pawn_hits / (double)result.pawn_probes);
+
+    FreeSearchThreads();
+    NnueUnload();
+    return 0;
+}
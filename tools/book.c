@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "book.h"
+#include "pgn.h"
+#include "timer.h"
+
+/*
+    Polyglot book tool (see include/book.h).
+
+    book --check                                 keys of the test positions of the Polyglot format
+    book --probe <book.bin> [fen]                book moves with their weights
+    book --bench <book.bin>                      key, lookup and pick latency
+    book --build <games.pgn> <out.bin> [plies] [threads]
+                                                 a book of the first plies (default 16) of every
+                                                 game, weighted by how often each move was played
+*/
+
+#define DEFAULT_BOOK_PLIES 16
+#define BENCH_PROBES 1000000
+
+static const struct {
+    const char* moves;
+    uint64_t key;
+} tests[] = {
+    { "",                              POLYGLOT_START_KEY },
+    { "e2e4",                          0x823C9B50FD114196ULL },
+    { "e2e4 d7d5",                     0x0756B94461C50FB0ULL },
+    { "e2e4 d7d5 e4e5",                0x662FAFB965DB29D4ULL },
+    { "e2e4 d7d5 e4e5 f7f5",           0x22A48B5A8E47FF78ULL },
+    { "e2e4 d7d5 e4e5 f7f5 e1e2",      0x652A607CA3F242C1ULL },
+    { "e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00FDD303C946BDD9ULL },
+    { "a2a4 b7b5 h2h4 b5b4 c2c4",      0x3C8123EA7B067637ULL },
+    { "a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5C3F9B829B279560ULL },
+};
+
+static int check(void) {
+    static Board_t board;
+    int failed = 0;
+
+    for(size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        InitBoard(&board);
+
+        char moves[64];
+        snprintf(moves, sizeof(moves), "%s", tests[i].moves);
+        for(char* name = strtok(moves, " "); name; name = strtok(NULL, " ")) PlayMove(&board, StringToMove(&board, name));
+
+        uint64_t key = PolyglotKey(&board);
+        printf("%-40s %016llx %s\n", tests[i].moves[0] ? tests[i].moves : "(start)", (unsigned long long)key,
+               key == tests[i].key ? "ok" : "MISMATCH");
+        failed += key != tests[i].key;
+    }
+
+    return failed != 0;
+}
+
+static int probe(const char* path, const char* fen) {
+    Book_t book;
+    if(!BookOpen(path, &book)) return 1;
+
+    static Board_t board;
+    if(fen && !InitBoardFromFen(&board, fen)) {
+        BookClose(&book);
+        return 1;
+    }
+    if(!fen) InitBoard(&board);
+
+    BookMove_t moves[MAX_MOVES];
+    int count = BookProbe(&book, &board, moves, MAX_MOVES);
+
+    uint64_t total = 0;
+    for(int i = 0; i < count; i++) total += moves[i].weight;
+
+    printf("Key %016llx, %d book moves\n", (unsigned long long)PolyglotKey(&board), count);
+    for(int i = 0; i < count; i++) {
+        char name[6];
+        MoveToString(moves[i].move, name);
+        printf("%-6s %6u %5.1f%%\n", name, moves[i].weight, total ? 100.0 * moves[i].weight / total : 0.0);
+    }
+
+    BookClose(&book);
+    return 0;
+}
+
+static uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static volatile uint64_t sink;
+
+static int bench(const char* path) {
+    Book_t book;
+    if(!BookOpen(path, &book)) return 1;
+    if(book.count == 0) {
+        printf("Empty book\n");
+        BookClose(&book);
+        return 0;
+    }
+
+    static Board_t board;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    printf("Entries: %zu (%.1f MB)\n", book.count, book.file.size / (double)(1 << 20));
+
+    // keys of positions a few random moves into the game
+    InitBoard(&board);
+    double start = NowSeconds();
+    for(int i = 0; i < BENCH_PROBES; i++) {
+        sink += PolyglotKey(&board);
+
+        MoveList_t list;
+        list.size = 0;
+        GenerateMoves(&board, &list);
+        if(i % 8 == 7 || list.size == 0) InitBoard(&board);
+        else PlayMove(&board, list.moves[nextRandom(&state) % list.size]);
+    }
+    double key_time = NowSeconds() - start;
+
+    // the walk above, without the keys, to take its own cost out
+    InitBoard(&board);
+    start = NowSeconds();
+    for(int i = 0; i < BENCH_PROBES; i++) {
+        MoveList_t list;
+        list.size = 0;
+        GenerateMoves(&board, &list);
+        if(i % 8 == 7 || list.size == 0) InitBoard(&board);
+        else PlayMove(&board, list.moves[nextRandom(&state) % list.size]);
+    }
+    key_time -= NowSeconds() - start;
+
+    // lookups of keys in the book, in random order
+    start = NowSeconds();
+    for(int i = 0; i < BENCH_PROBES; i++)
+        sink += BookFind(&book, BookEntryKey(&book.entries[nextRandom(&state) % book.count]));
+    double hit_time = NowSeconds() - start;
+
+    start = NowSeconds();
+    for(int i = 0; i < BENCH_PROBES; i++)
+        sink += BookFind(&book, nextRandom(&state));
+    double miss_time = NowSeconds() - start;
+
+    // everything a caller does: key, lookup, legal moves and the weighted pick
+    InitBoard(&board);
+    start = NowSeconds();
+    for(int i = 0; i < BENCH_PROBES; i++)
+        sink += BookPick(&book, &board, nextRandom(&state));
+    double pick_time = NowSeconds() - start;
+
+    printf("%-32s %8.1f ns\n", "key", key_time / BENCH_PROBES * 1e9);
+    printf("%-32s %8.1f ns\n", "lookup, in book", hit_time / BENCH_PROBES * 1e9);
+    printf("%-32s %8.1f ns\n", "lookup, not in book", miss_time / BENCH_PROBES * 1e9);
+    printf("%-32s %8.1f ns\n", "pick from the starting position", pick_time / BENCH_PROBES * 1e9);
+
+    BookClose(&book);
+    return 0;
+}
+
+typedef struct BuildEntry {
+    uint64_t key;
+    uint16_t move;
+} BuildEntry_t;
+
+typedef struct BuildList {
+    BuildEntry_t* entries;
+    size_t count, capacity;
+    Board_t board; // to walk each game back on
+} BuildList_t;
+
+typedef struct Build {
+    BuildList_t* lists; // one per thread
+    int plies;
+    bool failed;
+} Build_t;
+
+static void collectGame(const PgnGame_t* game, const Board_t* board, const PgnReplay_t* replay,
+                        PgnError_t error, int thread, void* data) {
+    (void)game;
+    if(error != PGN_OK) return;
+
+    Build_t* build = data;
+    BuildList_t* list = &build->lists[thread];
+    int plies = replay->plies < build->plies ? replay->plies : build->plies;
+
+    if(list->count + (size_t)plies > list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1 << 16;
+        while(capacity < list->count + (size_t)plies) capacity *= 2;
+
+        BuildEntry_t* entries = realloc(list->entries, capacity * sizeof(BuildEntry_t));
+        if(!entries) {
+            build->failed = true;
+            return;
+        }
+        list->entries = entries;
+        list->capacity = capacity;
+    }
+
+    CopyBoard(&list->board, board);
+    for(int ply = replay->plies - 1; ply >= 0; ply--) {
+        UnmakeMove(&list->board, &replay->undo[ply]);
+        if(ply < plies)
+            list->entries[list->count++] = (BuildEntry_t){ PolyglotKey(&list->board), PolyglotMove(replay->undo[ply].move) };
+    }
+}
+
+static int compareEntries(const void* a, const void* b) {
+    const BuildEntry_t* x = a;
+    const BuildEntry_t* y = b;
+    if(x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->move > y->move) - (x->move < y->move);
+}
+
+static int build(const char* in, const char* out, int plies, int threads) {
+    if(threads < 1) threads = 1;
+
+    static Build_t build;
+    build.plies = plies;
+    build.lists = calloc((size_t)threads, sizeof(BuildList_t));
+    if(!build.lists) return 1;
+
+    PgnStats_t stats;
+    if(!PgnScanFile(in, threads, collectGame, &build, &stats) || build.failed) {
+        ERROR("Failed to read %s", in);
+        return 1;
+    }
+
+    // all threads' moves in one list
+    size_t total = 0;
+    for(int t = 0; t < threads; t++) total += build.lists[t].count;
+
+    BuildEntry_t* all = malloc((total ? total : 1) * sizeof(BuildEntry_t));
+    if(!all) return 1;
+    size_t at = 0;
+    for(int t = 0; t < threads; t++) {
+        memcpy(all + at, build.lists[t].entries, build.lists[t].count * sizeof(BuildEntry_t));
+        at += build.lists[t].count;
+        free(build.lists[t].entries);
+    }
+    free(build.lists);
+
+    qsort(all, total, sizeof(BuildEntry_t), compareEntries);
+
+    FILE* file = fopen(out, "wb");
+    if(!file) {
+        ERROR("Failed to create %s", out);
+        free(all);
+        return 1;
+    }
+
+    // one entry per position and move, weighted by how often it was played
+    size_t written = 0;
+    for(size_t i = 0; i < total; ) {
+        size_t j = i;
+        while(j < total && all[j].key == all[i].key && all[j].move == all[i].move) j++;
+
+        BookEntry_t entry;
+        BookEncodeEntry(&entry, all[i].key, all[i].move, (uint16_t)(j - i < UINT16_MAX ? j - i : UINT16_MAX));
+        written += fwrite(&entry, sizeof(entry), 1, file);
+        i = j;
+    }
+
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    free(all);
+
+    printf("Games: %llu, moves: %zu, book entries: %zu\n", (unsigned long long)stats.games, total, written);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc > 1 && strcmp(argv[1], "--check") == 0) return check();
+    if(argc > 2 && strcmp(argv[1], "--probe") == 0) return probe(argv[2], argc > 3 ? argv[3] : NULL);
+    if(argc > 2 && strcmp(argv[1], "--bench") == 0) return bench(argv[2]);
+    if(argc > 3 && strcmp(argv[1], "--build") == 0) {
+        int plies = argc > 4 ? atoi(argv[4]) : DEFAULT_BOOK_PLIES;
+        int threads = argc > 5 ? atoi(argv[5]) : 1;
+        if(plies < 1) return 1;
+
+        return build(argv[2], argv[3], plies, threads);
+    }
+
+    fprintf(stderr, "usage: %s --check\n       %s --probe <book.bin> [fen]\n"
+            "       %s --bench <book.bin>\n       %s --build <games.pgn> <out.bin> [plies] [threads]\n",
+            argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+#include "engine.h"
+#include "timer.h"
+
+/*
+    Drives the GUI's engine worker (include/engine.h) without a window
+    and checks what comes back: searches, stops, queued jobs dropped by
+    a stop, ponderhits and ponder misses. Exits 1 if any check fails.
+
+    engine_check [movetime_ms]
+*/
+
+#define DEFAULT_MOVETIME 200
+#define LONG_MOVETIME 60000 // only ends when stopped
+#define SLACK_MS 1000       // for a loaded machine
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if(!ok) failures++;
+}
+
+// the next result, false if none arrives within timeout_ms. info events are dropped
+static bool waitResult(int64_t timeout_ms, EngineResult_t* result) {
+    int64_t deadline = NowMs() + timeout_ms;
+
+    while(NowMs() < deadline) {
+        SDL_Event event;
+        while(SDL_PollEvent(&event)) {
+            bool found = event.type == EngineResultEvent;
+            if(found) *result = *(const EngineResult_t*)event.user.data1;
+            EngineReleaseEvent(&event);
+            if(found) return true;
+        }
+        SDL_Delay(1);
+    }
+    return false;
+}
+
+static bool isLegal(Board_t* board, PackedMove_t move) {
+    MoveList_t list;
+    list.size = 0;
+    GenerateMoves(board, &list);
+
+    for(size_t i = 0; i < list.size; i++) {
+        if(list.moves[i] == move) return true;
+    }
+    return false;
+}
+
+static void searchTest(Board_t* board, int64_t movetime) {
+    EngineResult_t result;
+    int64_t start = NowMs();
+    uint32_t job = EngineSearch(board, movetime);
+
+    bool found = waitResult(movetime + SLACK_MS, &result);
+    check(found && result.job == job && !result.ponder, "search: its result arrives in time");
+    check(found && NowMs() - start >= movetime - 10, "search: uses its movetime");
+    check(found && result.key == board->key && isLegal(board, result.result.best_move), "search: plays a legal move");
+}
+
+static void stopTest(Board_t* board) {
+    EngineResult_t result;
+    uint32_t job = EngineSearch(board, LONG_MOVETIME);
+    SDL_Delay(100);
+    EngineStop();
+
+    bool found = waitResult(SLACK_MS, &result);
+    check(found && result.job == job, "stop: the running search ends and still sends its result");
+    check(found && isLegal(board, result.result.best_move), "stop: the stopped search has a move");
+}
+
+static void cancelTest(Board_t* board, int64_t movetime) {
+    EngineResult_t result;
+
+    // the first may have started before the stop, the second can't have
+    uint32_t first = EngineSearch(board, LONG_MOVETIME);
+    uint32_t second = EngineSearch(board, LONG_MOVETIME);
+    EngineStop();
+    uint32_t after = EngineSearch(board, movetime);
+
+    bool found = waitResult(movetime + SLACK_MS, &result);
+    if(found && result.job == first) found = waitResult(movetime + SLACK_MS, &result);
+
+    check(found && result.job == after, "cancel: the job queued after the stop runs");
+    check(!found || result.job != second, "cancel: a job stopped while queued sends nothing");
+    check(!waitResult(100, &result), "cancel: nothing else arrives");
+}
+
+static void ponderHitTest(Board_t* board, int64_t movetime) {
+    EngineResult_t result;
+    uint32_t job = EnginePonder(board, movetime);
+
+    // no clock while pondering, so nothing comes back on its own
+    check(!waitResult(movetime + 300, &result), "ponderhit: pondering runs past its movetime");
+
+    int64_t hit = NowMs();
+    EnginePonderHit();
+    bool found = waitResult(movetime + SLACK_MS, &result);
+    check(found && result.job == job && result.ponder, "ponderhit: the ponder search sends its result");
+    check(found && NowMs() - hit >= movetime - 10, "ponderhit: the movetime starts at the hit");
+
+    // a hit that lands before the worker has picked the job up
+    job = EnginePonder(board, movetime);
+    EnginePonderHit();
+    found = waitResult(movetime + SLACK_MS, &result);
+    check(found && result.job == job, "ponderhit: an early hit is not lost");
+}
+
+static void ponderMissTest(Board_t* board) {
+    EngineResult_t result;
+    uint32_t job = EnginePonder(board, LONG_MOVETIME);
+    SDL_Delay(50);
+    EngineStop();
+
+    bool found = waitResult(SLACK_MS, &result);
+    check(found && result.job == job && result.ponder, "ponder miss: the stopped ponder search ends");
+}
+
+int main(int argc, char* argv[]) {
+    int64_t movetime = argc > 1 ? atoi(argv[1]) : DEFAULT_MOVETIME;
+    if(movetime <= 0) movetime = DEFAULT_MOVETIME;
+
+    if(SDL_Init(SDL_INIT_EVENTS) != 0) {
+        printf("SDL_Init Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if(!EngineStart()) {
+        SDL_Quit();
+        return 1;
+    }
+
+    static Board_t board;
+    InitBoardFromFen(&board, STARTING_POSITION);
+
+    searchTest(&board, movetime);
+    stopTest(&board);
+    cancelTest(&board, movetime);
+    ponderHitTest(&board, movetime);
+    ponderMissTest(&board);
+
+    int64_t start = NowMs();
+    EngineShutdown();
+    check(NowMs() - start < SLACK_MS, "shutdown: the worker is joined");
+
+    freeBoard(&board);
+    SDL_Quit();
+
+    printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+}
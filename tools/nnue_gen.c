@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nnue.h"
+#include "evaluate.h"
+
+/*
+    Writes a network file in the layout nnue.h expects, with weights
+    taken from the midgame piece-square tables instead of training:
+    neuron p adds up our pieces of type p, neuron 6 + p the enemy's, each
+    in units of UNIT centipawns, and the output layer takes the
+    difference. Evaluates like the midgame piece-square sum, within
+    rounding. Good for exercising the loader, the incremental updates
+    and the kernels until a trained network replaces it.
+
+    nnue_gen <out.nnue>
+*/
+
+#define UNIT 16
+#define NEURON_BIAS 8   // keeps the king neurons (negative table values) above the clamp
+#define OUTPUT_WEIGHT 64
+
+static int16_t weights[NNUE_INPUTS][NNUE_HIDDEN];
+static int16_t bias[NNUE_HIDDEN];
+static int8_t output[2][NNUE_HIDDEN];
+
+static int roundUnits(int centipawns) {
+    return (centipawns >= 0) ? (centipawns + UNIT / 2) / UNIT : -((-centipawns + UNIT / 2) / UNIT);
+}
+
+static bool writeSection(FILE* file, const void* data, size_t size) {
+    static const uint8_t zeros[64] = { 0 };
+
+    if(fwrite(data, 1, size, file) != size) return false;
+
+    size_t pad = (64 - size % 64) % 64;
+    return fwrite(zeros, 1, pad, file) == pad;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc != 2) {
+        fprintf(stderr, "usage: %s <out.nnue>\n", argv[0]);
+        return 1;
+    }
+
+    InitEvaluation();
+
+    for(int p = 0; p < PIECE_IDX_COUNT; p++) {
+        bias[p] = NEURON_BIAS;
+        bias[PIECE_IDX_COUNT + p] = NEURON_BIAS;
+
+        for(int sq = 0; sq < SQUARE_COUNT; sq++) {
+            // inputs are relative to the perspective, so "ours" always reads the white table.
+            // an enemy piece on relative square sq stands on sq ^ 56 from its own side
+            weights[p * SQUARE_COUNT + sq][p] = roundUnits(PsqMg[WHITE_IDX][p][sq]);
+            weights[(PIECE_IDX_COUNT + p) * SQUARE_COUNT + sq][PIECE_IDX_COUNT + p] = roundUnits(PsqMg[WHITE_IDX][p][sq ^ 56]);
+        }
+
+        // both perspectives vote on (ours - theirs)
+        output[0][p] = OUTPUT_WEIGHT;
+        output[0][PIECE_IDX_COUNT + p] = -OUTPUT_WEIGHT;
+        output[1][p] = -OUTPUT_WEIGHT;
+        output[1][PIECE_IDX_COUNT + p] = OUTPUT_WEIGHT;
+    }
+
+    // one unit of (ours - theirs) sums to 2 * OUTPUT_WEIGHT and must come out as UNIT centipawns
+    NnueHeader_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, NNUE_MAGIC, sizeof(header.magic));
+    header.version = NNUE_VERSION;
+    header.inputs = NNUE_INPUTS;
+    header.hidden = NNUE_HIDDEN;
+    header.scale = UNIT * NNUE_QA * NNUE_QB / (2 * OUTPUT_WEIGHT);
+    header.output_bias = 10 * NNUE_QA * NNUE_QB / header.scale; // tempo, as in Evaluate()
+
+    FILE* file = fopen(argv[1], "wb");
+    if(!file) {
+        fprintf(stderr, "Failed to create %s\n", argv[1]);
+        return 1;
+    }
+
+    bool ok = writeSection(file, &header, sizeof(header))
+           && writeSection(file, bias, sizeof(bias))
+           && writeSection(file, weights, sizeof(weights))
+           && writeSection(file, output, sizeof(output));
+
+    if(fclose(file) != 0) ok = false;
+
+    if(!ok) {
+        fprintf(stderr, "Failed to write %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("Wrote %s\n", argv[1]);
+    return 0;
+}
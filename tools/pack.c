@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "packed.h"
+#include "epd.h"
+#include "pgn.h"
+#include "timer.h"
+
+/*
+    Builds and reads packed position files (include/packed.h).
+
+    pack <in.epd> <out.bin> [threads]         every position of an EPD file
+    pack --pgn <in.pgn> <out.bin> [threads]   every position of every game that replays cleanly
+    pack --dump <file> <n>                    record n as a FEN
+    pack --read <file> [count]                unpacks count random records into a Board_t, records/sec
+
+    With more than one thread, PGN games are written whole but in the
+    order the threads finish them.
+*/
+
+#define DEFAULT_READS 1000000
+
+static int packEpd(const char* in, const char* out, int threads) {
+    EpdSet_t set;
+    if(!LoadEpdFile(in, threads, &set)) return 1;
+
+    PackedWriter_t writer;
+    if(!CreatePackedFile(out, &writer)) {
+        FreeEpdSet(&set);
+        return 1;
+    }
+
+    // through a small buffer, so the output never needs a second copy of the whole set
+    PackedPosition_t buffer[4096];
+    size_t buffered = 0, skipped = 0;
+    bool ok = true;
+
+    for(size_t i = 0; i < set.count && ok; i++) {
+        if(!PackPosition(&set.positions[i], &buffer[buffered])) {
+            skipped++;
+            continue;
+        }
+
+        if(++buffered == sizeof(buffer) / sizeof(buffer[0])) {
+            ok = WritePacked(&writer, buffer, buffered);
+            buffered = 0;
+        }
+    }
+    if(ok && buffered) ok = WritePacked(&writer, buffer, buffered);
+
+    ok = ClosePackedWriter(&writer) && ok;
+    printf("Positions: %zu written, %zu rejected lines, %zu that can't be packed\n", writer.count, set.rejected, skipped);
+
+    FreeEpdSet(&set);
+    return ok ? 0 : 1;
+}
+
+typedef struct PgnPack {
+    PackedWriter_t writer;
+    mtx_t lock;
+    bool ok;
+
+    Board_t* boards; // one per thread, to walk each game back on
+    PackedPosition_t (*positions)[MAX_GAME_PLY + 1];
+} PgnPack_t;
+
+static void packGame(const PgnGame_t* game, const Board_t* board, const PgnReplay_t* replay,
+                     PgnError_t error, int thread, void* data) {
+    (void)game;
+    if(error != PGN_OK) return;
+
+    PgnPack_t* pack = data;
+    Board_t* walk = &pack->boards[thread];
+    PackedPosition_t* positions = pack->positions[thread];
+    CopyBoard(walk, board);
+
+    // last position first, then each one before it
+    int count = replay->plies + 1;
+    PackBoard(walk, &positions[replay->plies]);
+    for(int ply = replay->plies - 1; ply >= 0; ply--) {
+        UnmakeMove(walk, &replay->undo[ply]);
+        PackBoard(walk, &positions[ply]);
+    }
+
+    mtx_lock(&pack->lock);
+    if(pack->ok) pack->ok = WritePacked(&pack->writer, positions, (size_t)count);
+    mtx_unlock(&pack->lock);
+}
+
+static int packPgn(const char* in, const char* out, int threads) {
+    static PgnPack_t pack;
+    if(threads < 1) threads = 1;
+
+    pack.boards = malloc((size_t)threads * sizeof(Board_t));
+    pack.positions = malloc((size_t)threads * sizeof(*pack.positions));
+    if(!pack.boards || !pack.positions || mtx_init(&pack.lock, mtx_plain) != thrd_success) {
+        ERROR("Out of memory");
+        return 1;
+    }
+
+    if(!CreatePackedFile(out, &pack.writer)) return 1;
+    pack.ok = true;
+
+    PgnStats_t stats;
+    bool scanned = PgnScanFile(in, threads, packGame, &pack, &stats);
+    bool ok = ClosePackedWriter(&pack.writer) && pack.ok && scanned;
+
+    uint64_t failed = 0;
+    for(int e = 0; e < PGN_ERROR_COUNT; e++) failed += stats.failed[e];
+    printf("Games: %llu (%llu skipped), positions: %zu\n", (unsigned long long)stats.games,
+           (unsigned long long)failed, pack.writer.count);
+
+    mtx_destroy(&pack.lock);
+    free(pack.boards);
+    free(pack.positions);
+    return ok ? 0 : 1;
+}
+
+static int dump(const char* path, size_t n) {
+    PackedFile_t file;
+    if(!OpenPackedFile(path, &file)) return 1;
+
+    const PackedPosition_t* record = PackedRecord(&file, n);
+    FenPosition_t position;
+    static Board_t board;
+    int status = 1;
+
+    if(!record) {
+        ERROR("%s has %zu records", path, file.count);
+    } else if(!UnpackPosition(record, &position)) {
+        ERROR("Record %zu is damaged", n);
+    } else {
+        char fen[FEN_MAX_LENGTH];
+        InitBoardFromPosition(&board, &position);
+        WriteFen(&board, fen, sizeof(fen));
+        printf("%s\n", fen);
+        status = 0;
+    }
+
+    ClosePackedFile(&file);
+    return status;
+}
+
+static int readRandom(const char* path, size_t reads) {
+    PackedFile_t file;
+    if(!OpenPackedFile(path, &file)) return 1;
+    if(file.count == 0) {
+        printf("Records: 0\n");
+        ClosePackedFile(&file);
+        return 0;
+    }
+
+    static Board_t board;
+    uint64_t state = 0x9E3779B97F4A7C15ULL, checksum = 0;
+    size_t damaged = 0;
+    double start = NowSeconds();
+
+    for(size_t i = 0; i < reads; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        if(UnpackBoard(PackedRecord(&file, state % file.count), &board)) checksum ^= board.key;
+        else damaged++;
+    }
+
+    double elapsed = NowSeconds() - start;
+    printf("Records: %zu (%.1f MB)\n", file.count, file.file.size / (double)(1 << 20));
+    printf("Random reads: %zu, damaged: %zu, key checksum %016llx\n", reads, damaged, (unsigned long long)checksum);
+    printf("Time: %.3f s\n", elapsed);
+    printf("Records/sec: %.0f\n", elapsed > 0 ? reads / elapsed : 0.0);
+
+    ClosePackedFile(&file);
+    return damaged != 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc > 3 && strcmp(argv[1], "--pgn") == 0)
+        return packPgn(argv[2], argv[3], (argc > 4) ? atoi(argv[4]) : 1);
+
+    if(argc > 3 && strcmp(argv[1], "--dump") == 0)
+        return dump(argv[2], strtoull(argv[3], NULL, 10));
+
+    if(argc > 2 && strcmp(argv[1], "--read") == 0)
+        return readRandom(argv[2], (argc > 3) ? strtoull(argv[3], NULL, 10) : DEFAULT_READS);
+
+    if(argc > 2 && argv[1][0] != '-')
+        return packEpd(argv[1], argv[2], (argc > 3) ? atoi(argv[3]) : 1);
+
+    fprintf(stderr, "usage: %s <in.epd> <out.bin> [threads]\n       %s --pgn <in.pgn> <out.bin> [threads]\n"
+            "       %s --dump <file> <n>\n       %s --read <file> [count]\n", argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+}
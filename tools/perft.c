@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "board.h"
+#include "perft.h"
+#include "fen.h"
+#include "zobrist.h"
+#include "evaluate.h"
+
+/*
+    Headless move generation driver, never touches the renderer.
+
+    perft <depth> [fen]              divide for each root move, total and nodes/sec
+    perft --epd <file> [max_depth]   check every ";D<n> <count>" entry of a suite
+    perft --verify <depth> [fen]     compare the incrementally kept keys and piece-square
+                                     sums with from-scratch ones after every make and
+                                     unmake, the standard positions when no fen is given.
+                                     these runs also check that illegal positions are refused
+*/
+
+#define MAX_REPORTED 10
+
+static const char* verify_positions[] = {
+    STARTING_POSITION,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+// positions ParseFen has to refuse, each would lose a king once searched
+static const struct { const char* fen; FenError_t error; } invalid_positions[] = {
+    { "4k3/8/8/8/8/8/4Q3/4K3 w - - 0 1", FEN_ERROR_CHECK },  // black in check, white to move
+    { "4k3/8/8/8/8/8/8/4K2r b - - 0 1", FEN_ERROR_CHECK },   // white in check, black to move
+    { "4k3/8/8/8/1b6/8/8/4K3 b - - 0 1", FEN_ERROR_CHECK },  // a diagonal check
+    { "4k3/8/8/8/8/8/3p4/4K3 b - - 0 1", FEN_ERROR_CHECK },  // a pawn check
+    { "8/8/8/8/8/8/8/Kk6 w - - 0 1", FEN_ERROR_CHECK },      // kings side by side
+};
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void printSpeed(uint64_t nodes, double seconds) {
+    printf("Nodes: %llu\n", (unsigned long long)nodes);
+    printf("Time: %.3f s\n", seconds);
+    printf("NPS: %.0f\n", seconds > 0 ? nodes / seconds : 0.0);
+}
+
+static uint64_t divide(Board_t* board, int depth) {
+    MoveList_t movelist;
+    movelist.size = 0;
+    GenerateMoves(board, &movelist);
+
+    uint64_t total = 0;
+
+    for(size_t i = 0; i < movelist.size; i++) {
+        UndoInfo_t undo;
+        MakeMove(board, movelist.moves[i], &undo);
+
+        uint64_t nodes = Perft(board, depth - 1);
+        char name[6];
+        MoveToString(movelist.moves[i], name);
+        printf("%s: %llu\n", name, (unsigned long long)nodes);
+        total += nodes;
+
+        UnmakeMove(board, &undo);
+    }
+
+    return total;
+}
+
+static int runFen(const char* fen, int depth) {
+    static Board_t board;
+    if(!InitBoardFromFen(&board, fen)) return 1;
+
+    double start = now();
+    uint64_t nodes = depth > 0 ? divide(&board, depth) : 1;
+    double elapsed = now() - start;
+
+    printf("\n");
+    printSpeed(nodes, elapsed);
+    return 0;
+}
+
+// lines look like: <fen> ;D1 20 ;D2 400 ;D3 8902
+static int runSuite(const char* path, int max_depth) {
+    FILE* file = fopen(path, "r");
+    if(!file) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return 1;
+    }
+
+    static Board_t board;
+    char line[1024];
+    int passed = 0, failed = 0, line_no = 0;
+    uint64_t total_nodes = 0;
+    double start = now();
+
+    while(fgets(line, sizeof(line), file)) {
+        line_no++;
+
+        char* fields = strchr(line, ';');
+        if(!fields) continue; // blank line or no expectations
+        *fields++ = '\0';
+
+        if(!InitBoardFromFen(&board, line)) {
+            failed++;
+            printf("FAIL line %d: not a valid FEN\n  %s\n", line_no, line);
+            continue;
+        }
+
+        for(char* entry = strtok(fields, ";"); entry; entry = strtok(NULL, ";")) {
+            int depth;
+            unsigned long long expected;
+            if(sscanf(entry, " D%d %llu", &depth, &expected) != 2) continue;
+            if(depth > max_depth) continue;
+
+            uint64_t nodes = Perft(&board, depth);
+            total_nodes += nodes;
+
+            if(nodes == expected) {
+                passed++;
+            } else {
+                failed++;
+                printf("FAIL line %d depth %d: expected %llu, got %llu\n  %s\n",
+                    line_no, depth, expected, (unsigned long long)nodes, line);
+            }
+        }
+    }
+
+    fclose(file);
+
+    printf("%d passed, %d failed\n", passed, failed);
+    printSpeed(total_nodes, now() - start);
+    return failed ? 1 : 0;
+}
+
+static uint64_t verified, mismatches;
+
+// the first field that differs from its from-scratch value, NULL if none does
+static const char* incrementalMismatch(const Board_t* board) {
+    if(board->key != ComputeKey(board)) return "key";
+    if(board->pawn_key != ComputePawnKey(board)) return "pawn_key";
+
+    int mg, eg, phase;
+    ComputePsq(board, &mg, &eg, &phase);
+    if(board->psq_mg != mg) return "psq_mg";
+    if(board->psq_eg != eg) return "psq_eg";
+    if(board->phase != phase) return "phase";
+    return NULL;
+}
+
+static void verifyState(const Board_t* board, const char* when, PackedMove_t move) {
+    verified++;
+
+    const char* field = incrementalMismatch(board);
+    if(!field || mismatches++ >= MAX_REPORTED) return;
+
+    char fen[FEN_MAX_LENGTH], name[6];
+    WriteFen(board, fen, sizeof(fen));
+    MoveToString(move, name);
+    printf("MISMATCH %s after %s %s: %s\n", field, when, name, fen);
+}
+
+static void verifyTree(Board_t* board, int depth) {
+    if(depth == 0) return;
+
+    MoveList_t movelist;
+    movelist.size = 0;
+    GenerateMoves(board, &movelist);
+
+    for(size_t i = 0; i < movelist.size; i++) {
+        UndoInfo_t undo;
+        MakeMove(board, movelist.moves[i], &undo);
+        verifyState(board, "making", movelist.moves[i]);
+
+        verifyTree(board, depth - 1);
+
+        UnmakeMove(board, &undo);
+        verifyState(board, "unmaking", movelist.moves[i]);
+    }
+}
+
+// the number of invalid_positions ParseFen accepted or refused for another reason
+static int checkInvalid(void) {
+    int failed = 0;
+
+    for(size_t i = 0; i < sizeof(invalid_positions) / sizeof(invalid_positions[0]); i++) {
+        FenPosition_t position;
+        const char* fen = invalid_positions[i].fen;
+        FenError_t error = ParseFen(fen, strlen(fen), &position, NULL);
+
+        if(error != invalid_positions[i].error) {
+            printf("FAIL %s: expected \"%s\", got \"%s\"\n",
+                fen, FenErrorString(invalid_positions[i].error), FenErrorString(error));
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+static int runVerify(const char* fen, int depth) {
+    static Board_t board;
+    double start = now();
+    int refused = fen ? 0 : checkInvalid();
+
+    int count = fen ? 1 : (int)(sizeof(verify_positions) / sizeof(verify_positions[0]));
+    for(int i = 0; i < count; i++) {
+        if(!InitBoardFromFen(&board, fen ? fen : verify_positions[i])) {
+            fprintf(stderr, "Not a valid FEN: %s\n", fen ? fen : verify_positions[i]);
+            return 1;
+        }
+        verifyTree(&board, depth);
+    }
+
+    printf("%llu states checked, %llu mismatches\n", (unsigned long long)verified, (unsigned long long)mismatches);
+    printf("Time: %.3f s\n", now() - start);
+    return (mismatches || refused) ? 1 : 0;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s <depth> [fen]\n", name);
+    fprintf(stderr, "       %s --epd <file> [max_depth]\n", name);
+    fprintf(stderr, "       %s --verify <depth> [fen]\n", name);
+}
+
+int main(int argc, char* argv[]) {
+    if(argc >= 3 && strcmp(argv[1], "--epd") == 0) {
+        return runSuite(argv[2], argc > 3 ? atoi(argv[3]) : 6);
+    }
+
+    bool verify = argc >= 3 && strcmp(argv[1], "--verify") == 0;
+    int first = verify ? 2 : 1;
+    if(argc <= first) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // the fen may be passed unquoted, glue the remaining arguments back together
+    char fen[256] = STARTING_POSITION;
+    if(argc > first + 1) {
+        fen[0] = '\0';
+        for(int i = first + 1; i < argc; i++) {
+            if(i > first + 1) strncat(fen, " ", sizeof(fen) - strlen(fen) - 1);
+            strncat(fen, argv[i], sizeof(fen) - strlen(fen) - 1);
+        }
+    }
+
+    if(verify) return runVerify(argc > first + 1 ? fen : NULL, atoi(argv[first]));
+    return runFen(fen, atoi(argv[first]));
+}
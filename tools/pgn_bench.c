@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "pgn.h"
+#include "timer.h"
+
+/*
+    Headless PGN throughput check: parses every game of a file, resolves
+    each SAN move and replays it, then prints games/sec and games per
+    minute per thread. The first few games that fail are listed on
+    stderr with their byte offset.
+
+    pgn_bench <file> [threads]
+*/
+
+#define SHOWN_ERRORS 10
+
+static atomic_int shown;
+
+static void reportGame(const PgnGame_t* game, const Board_t* board, const PgnReplay_t* replay,
+                       PgnError_t error, int thread, void* data) {
+    (void)board;
+    (void)thread;
+    (void)data;
+
+    if(error == PGN_OK || atomic_fetch_add(&shown, 1) >= SHOWN_ERRORS) return;
+
+    if(error == PGN_ERROR_MOVE) {
+        fprintf(stderr, "game at byte %zu, ply %d: %s \"%.*s\"\n", game->offset, replay->plies + 1,
+                PgnErrorString(error), (int)replay->bad_move.length, replay->bad_move.text);
+    } else {
+        fprintf(stderr, "game at byte %zu: %s\n", game->offset, PgnErrorString(error));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s <file> [threads]\n", argv[0]);
+        return 1;
+    }
+
+    int threads = (argc > 2) ? atoi(argv[2]) : 1;
+    if(threads < 1) return 1;
+
+    PgnStats_t stats;
+    double start = NowSeconds();
+    if(!PgnScanFile(argv[1], threads, reportGame, NULL, &stats)) return 1;
+    double elapsed = NowSeconds() - start;
+
+    uint64_t failed = 0;
+    for(int e = 0; e < PGN_ERROR_COUNT; e++) failed += stats.failed[e];
+
+    printf("Games: %llu (%llu failed)\n", (unsigned long long)stats.games, (unsigned long long)failed);
+    for(int e = PGN_OK + 1; e < PGN_ERROR_COUNT; e++) {
+        if(stats.failed[e]) printf("  %s: %llu\n", PgnErrorString((PgnError_t)e), (unsigned long long)stats.failed[e]);
+    }
+    printf("Plies: %llu\n", (unsigned long long)stats.plies);
+    printf("Time: %.3f s (%d threads)\n", elapsed, threads);
+
+    double per_second = elapsed > 0 ? stats.games / elapsed : 0.0;
+    printf("Games/sec: %.0f\n", per_second);
+    printf("Games/min per thread: %.0f\n", per_second * 60 / threads);
+    printf("MB/sec: %.1f\n", elapsed > 0 ? stats.bytes / elapsed / (1 << 20) : 0.0);
+
+    return failed != 0;
+}
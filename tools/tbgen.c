@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tablebase.h"
+#include "fen.h"
+#include "timer.h"
+
+/*
+    Generates and checks endgame tablebases (include/tablebase.h).
+
+    tbgen <dir> <material>... [--threads n]   KQK, KRK, KPK, KBNK ... and whatever they lead to
+    tbgen --probe <dir> <fen>                 the position's result and the result after each move
+    tbgen --verify <dir> <material> [count]   count random positions (0: all) against the move generator
+    tbgen --bench <dir>                       probes per second over the mapped tables
+*/
+
+#define DEFAULT_VERIFY 200000
+#define BENCH_BOARDS 64
+#define BENCH_PROBES 2000000
+
+static uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void describe(const TbResult_t* result, char* out, size_t size) {
+    if(result->wdl == TB_DRAW) snprintf(out, size, "draw");
+    else snprintf(out, size, "%s in %d plies", result->wdl == TB_WIN ? "mate" : "mated", result->plies);
+}
+
+// higher is better for the side to move: fast wins, then draws, then slow losses
+static int resultScore(const TbResult_t* result) {
+    if(result->wdl == TB_WIN) return 1000 - result->plies;
+    if(result->wdl == TB_LOSS) return result->plies - 1000;
+    return 0;
+}
+
+// a board for the table position, white strong as stored or with the colors swapped
+static void setUpBoard(Board_t* board, const TbMaterial_t* material, const TbPosition_t* position, bool swap) {
+    FenPosition_t fen;
+    memset(&fen, 0, sizeof(fen));
+
+    int flip = swap ? (DIM_Y - 1) * DIM_X : 0;
+    ColorIndex_t strong = swap ? BLACK_IDX : WHITE_IDX;
+    ColorIndex_t weak = swap ? WHITE_IDX : BLACK_IDX;
+
+    fen.squares[position->strong_king ^ flip] = FEN_PIECE(strong, KING_IDX);
+    fen.squares[position->weak_king ^ flip] = FEN_PIECE(weak, KING_IDX);
+    for(int i = 0; i < material->count; i++) fen.squares[position->pieces[i] ^ flip] = FEN_PIECE(strong, material->pieces[i]);
+
+    fen.turn = ((position->turn == WHITE_IDX) != swap) ? WHITE : BLACK;
+    fen.ep_square = NO_SQUARE;
+    fen.fullmove = 1;
+
+    InitBoardFromPosition(board, &fen);
+}
+
+// what the position is worth from its moves and the tables behind them. false if one of them isn't mapped
+static bool fromMoves(Board_t* board, TbResult_t* result) {
+    MoveList_t list;
+    list.size = 0;
+    GenerateMoves(board, &list);
+
+    if(list.size == 0) {
+        *result = IsCheck(board, board->turn) ? (TbResult_t){ TB_LOSS, 0 } : (TbResult_t){ TB_DRAW, 0 };
+        return true;
+    }
+
+    bool found = false;
+    for(size_t i = 0; i < list.size; i++) {
+        UndoInfo_t undo;
+        TbResult_t child;
+
+        MakeMove(board, list.moves[i], &undo);
+        bool ok = TbProbe(board, &child);
+        UnmakeMove(board, &undo);
+        if(!ok) return false;
+
+        TbResult_t mine = { (TbWdl_t)-child.wdl, child.wdl == TB_DRAW ? 0 : child.plies + 1 };
+        if(!found || resultScore(&mine) > resultScore(result)) *result = mine;
+        found = true;
+    }
+
+    return true;
+}
+
+static int generate(const char* dir, char** materials, int count, int threads) {
+    for(int i = 0; i < count; i++) {
+        TbMaterial_t material;
+        if(!TbParseMaterial(materials[i], &material)) {
+            ERROR("%s is not a material this generator handles, e.g. KQK or KBNK", materials[i]);
+            return 1;
+        }
+
+        TbGenStats_t stats;
+        double start = NowSeconds();
+        if(!TbGenerate(dir, &material, threads, &stats)) return 1;
+
+        char name[8];
+        TbMaterialName(&material, name);
+        printf("%-6s %10zu entries  %9zu wins  %9zu losses  %9zu draws  longest mate %3d plies  %d table(s) in %.2f s\n",
+               name, stats.entries, stats.wins, stats.losses, stats.draws, stats.longest, stats.tables, NowSeconds() - start);
+    }
+
+    return 0;
+}
+
+static int probe(const char* dir, const char* fen) {
+    TbOpen(dir);
+
+    static Board_t board;
+    if(!InitBoardFromFen(&board, fen)) return 1;
+
+    TbResult_t result;
+    char text[64];
+    if(!TbProbe(&board, &result)) {
+        printf("No table for this position\n");
+        return 1;
+    }
+    describe(&result, text, sizeof(text));
+    printf("%s\n", text);
+
+    MoveList_t list;
+    list.size = 0;
+    GenerateMoves(&board, &list);
+
+    for(size_t i = 0; i < list.size; i++) {
+        UndoInfo_t undo;
+        MakeMove(&board, list.moves[i], &undo);
+
+        char name[6];
+        MoveToString(list.moves[i], name);
+        if(TbProbe(&board, &result)) {
+            describe(&result, text, sizeof(text));
+            printf("%-6s %s for the opponent\n", name, text);
+        } else {
+            printf("%-6s no table\n", name);
+        }
+
+        UnmakeMove(&board, &undo);
+    }
+
+    return 0;
+}
+
+static int verify(const char* dir, const char* name, size_t samples) {
+    TbMaterial_t material;
+    if(!TbParseMaterial(name, &material)) return 1;
+    if(TbOpen(dir) == 0) {
+        ERROR("No tables in %s", dir);
+        return 1;
+    }
+
+    static Board_t board;
+    size_t entries = TbEntries(&material), checked = 0, failed = 0;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    size_t count = samples ? samples : entries;
+
+    for(size_t n = 0; n < count; n++) {
+        size_t index = samples ? nextRandom(&state) % entries : n;
+
+        TbPosition_t position;
+        TbDecode(&material, index, &position);
+        if(TbProbeValue(&material, &position) == TB_VALUE_ILLEGAL) continue;
+
+        // every other position with black as the strong side
+        setUpBoard(&board, &material, &position, n & 1);
+
+        TbResult_t stored, expected;
+        if(!TbProbe(&board, &stored) || !fromMoves(&board, &expected)) {
+            ERROR("Missing table for a position of %s", name);
+            return 1;
+        }
+
+        checked++;
+        if(stored.wdl != expected.wdl || stored.plies != expected.plies) {
+            char fen[FEN_MAX_LENGTH], a[64], b[64];
+            WriteFen(&board, fen, sizeof(fen));
+            describe(&stored, a, sizeof(a));
+            describe(&expected, b, sizeof(b));
+            if(failed++ < 10) printf("MISMATCH %s: table says %s, its moves say %s\n", fen, a, b);
+        }
+    }
+
+    printf("%s: %zu positions checked, %zu mismatches\n", name, checked, failed);
+    return failed != 0;
+}
+
+static volatile int sink;
+
+static int bench(const char* dir) {
+    int tables = TbOpen(dir);
+    if(tables == 0) {
+        ERROR("No tables in %s", dir);
+        return 1;
+    }
+
+    // random legal positions, a few from each mapped table
+    static Board_t boards[BENCH_BOARDS];
+    static const char* names[] = { "KQK", "KRK", "KPK", "KBNK", "KQRK", "KRBK", "KPPK", "KBBK", "KQPK", "KRPK" };
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    int count = 0;
+
+    for(int attempt = 0; attempt < 100000 && count < BENCH_BOARDS; attempt++) {
+        TbMaterial_t material;
+        TbParseMaterial(names[attempt % (int)(sizeof(names) / sizeof(names[0]))], &material);
+
+        TbPosition_t position;
+        TbDecode(&material, nextRandom(&state) % TbEntries(&material), &position);
+        uint8_t value = TbProbeValue(&material, &position);
+        if(value == TB_VALUE_ILLEGAL) continue;
+
+        setUpBoard(&boards[count++], &material, &position, attempt & 1);
+    }
+
+    double start = NowSeconds();
+    for(int i = 0; i < BENCH_PROBES; i++) {
+        TbResult_t result;
+        sink += TbProbe(&boards[nextRandom(&state) % (uint64_t)count], &result) ? result.plies : -1;
+    }
+    double elapsed = NowSeconds() - start;
+
+    printf("Tables: %d, positions: %d\n", tables, count);
+    printf("%.1f ns per probe, %.1f M probes/sec\n", elapsed / BENCH_PROBES * 1e9, BENCH_PROBES / elapsed / 1e6);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc > 3 && strcmp(argv[1], "--probe") == 0) return probe(argv[2], argv[3]);
+    if(argc > 3 && strcmp(argv[1], "--verify") == 0)
+        return verify(argv[2], argv[3], argc > 4 ? (size_t)strtoull(argv[4], NULL, 10) : DEFAULT_VERIFY);
+    if(argc > 2 && strcmp(argv[1], "--bench") == 0) return bench(argv[2]);
+
+    if(argc < 3 || argv[1][0] == '-') {
+        fprintf(stderr, "usage: %s <dir> <material>... [--threads n]\n       %s --probe <dir> <fen>\n"
+                "       %s --verify <dir> <material> [count]\n       %s --bench <dir>\n", argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    int threads = 1, count = 0;
+    char* materials[64];
+    for(int i = 2; i < argc && count < 64; i++) {
+        if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else materials[count++] = argv[i];
+    }
+
+    return generate(argv[1], materials, count, threads);
+}
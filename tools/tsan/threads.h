@@ -0,0 +1,79 @@
+#ifndef CHESS_TSAN_THREADS_H
+#define CHESS_TSAN_THREADS_H
+
+/*
+    Stands in for <threads.h> in -DCHESS_TSAN=ON builds only.
+
+    glibc implements C11 threads on internal pthread entry points that
+    ThreadSanitizer (as shipped with gcc 12) doesn't intercept, so a
+    thrd_create'd thread crashes it on start. These wrappers call the
+    public pthread functions instead, which it does see. Only what the
+    engine uses is here.
+*/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef pthread_t thrd_t;
+typedef pthread_mutex_t mtx_t;
+typedef pthread_cond_t cnd_t;
+typedef int (*thrd_start_t)(void*);
+
+enum { thrd_success = 0, thrd_error = 2, thrd_nomem = 3 };
+enum { mtx_plain = 0 };
+
+typedef struct TsanThreadStart {
+    thrd_start_t function;
+    void* arg;
+} TsanThreadStart_t;
+
+static void* tsanThreadMain(void* arg) {
+    TsanThreadStart_t start = *(TsanThreadStart_t*)arg;
+    free(arg);
+    return (void*)(intptr_t)start.function(start.arg);
+}
+
+static inline int thrd_create(thrd_t* thread, thrd_start_t function, void* arg) {
+    TsanThreadStart_t* start = malloc(sizeof(*start));
+    if(!start) return thrd_nomem;
+
+    start->function = function;
+    start->arg = arg;
+    if(pthread_create(thread, NULL, tsanThreadMain, start) != 0) {
+        free(start);
+        return thrd_error;
+    }
+    return thrd_success;
+}
+
+static inline int thrd_join(thrd_t thread, int* result) {
+    void* value;
+    if(pthread_join(thread, &value) != 0) return thrd_error;
+    if(result) *result = (int)(intptr_t)value;
+    return thrd_success;
+}
+
+static inline int thrd_sleep(const struct timespec* duration, struct timespec* remaining) {
+    return nanosleep(duration, remaining) == 0 ? 0 : -1;
+}
+
+static inline int mtx_init(mtx_t* mutex, int type) {
+    (void)type;
+    return pthread_mutex_init(mutex, NULL) == 0 ? thrd_success : thrd_error;
+}
+
+static inline void mtx_destroy(mtx_t* mutex) { pthread_mutex_destroy(mutex); }
+static inline int mtx_lock(mtx_t* mutex) { return pthread_mutex_lock(mutex) == 0 ? thrd_success : thrd_error; }
+static inline int mtx_unlock(mtx_t* mutex) { return pthread_mutex_unlock(mutex) == 0 ? thrd_success : thrd_error; }
+
+static inline int cnd_init(cnd_t* cond) { return pthread_cond_init(cond, NULL) == 0 ? thrd_success : thrd_error; }
+static inline void cnd_destroy(cnd_t* cond) { pthread_cond_destroy(cond); }
+static inline int cnd_signal(cnd_t* cond) { return pthread_cond_signal(cond) == 0 ? thrd_success : thrd_error; }
+static inline int cnd_broadcast(cnd_t* cond) { return pthread_cond_broadcast(cond) == 0 ? thrd_success : thrd_error; }
+static inline int cnd_wait(cnd_t* cond, mtx_t* mutex) {
+    return pthread_cond_wait(cond, mutex) == 0 ? thrd_success : thrd_error;
+}
+
+#endif // CHESS_TSAN_THREADS_H
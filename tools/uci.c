@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include "board.h"
+#include "fen.h"
+#include "search.h"
+#include "tt.h"
+#include "nnue.h"
+#include "book.h"
+#include "tablebase.h"
+#include "timer.h"
+
+/*
+    UCI front end over stdin/stdout, for GUIs and tournament managers.
+
+    The main thread does nothing but read commands, so stop and ponderhit
+    reach a running search right away: they only set flags that the
+    search polls every few thousand nodes. Each go runs on its own
+    thread, which prints info lines and the bestmove itself.
+
+    Supported: uci, isready, ucinewgame, setoption (Hash, Threads,
+    EvalFile, OwnBook, BookFile, TablebasePath), position [startpos | fen <fen>] [moves ...], go [depth,
+    movetime, wtime, btime, winc, binc, movestogo, nodes, infinite,
+    ponder], stop, ponderhit, quit.
+
+    With OwnBook on, a go in a book position answers with a book move
+    right away, unless it is infinite or a ponder search. TablebasePath
+    is a directory of tables written by tbgen, see include/tablebase.h.
+*/
+
+#define ENGINE_NAME "Chess"
+#define MAX_LINE 16384
+
+#define MAX_HASH_MB 65536
+#define MOVE_OVERHEAD 30 // ms kept back per move for the GUI and the pipe
+
+static Board_t board;
+
+static struct {
+    thrd_t thread;
+    bool running;
+
+    SearchLimits_t limits;
+    Board_t board; // the position as it was at go, so a new position command can't change it mid-search
+    atomic_bool stop;
+    atomic_bool ponder;
+} search;
+
+static struct {
+    Book_t book;
+    bool open;
+    bool enabled;      // OwnBook
+    uint64_t random;   // xorshift state for the weighted pick
+} book;
+
+static void printScore(char* out, size_t size, int score) {
+    if(score > SCORE_MATE_IN_MAX) snprintf(out, size, "mate %d", (SCORE_MATE - score + 1) / 2);
+    else if(score < -SCORE_MATE_IN_MAX) snprintf(out, size, "mate %d", -(SCORE_MATE + score) / 2);
+    else snprintf(out, size, "cp %d", score);
+}
+
+static void reportInfo(const SearchInfo_t* info, void* data) {
+    (void)data;
+
+    char line[64 + MAX_PLY * 6];
+    char score[32];
+    printScore(score, sizeof(score), info->score);
+
+    int length = snprintf(line, sizeof(line), "info depth %d score %s nodes %llu nps %llu time %lld hashfull %d pv",
+                          info->depth, score, (unsigned long long)info->nodes, (unsigned long long)info->nps,
+                          (long long)info->time_ms, info->hashfull);
+
+    for(int i = 0; i < info->pv_length; i++) {
+        char name[6];
+        MoveToString(info->pv[i], name);
+        length += snprintf(line + length, sizeof(line) - length, " %s", name);
+    }
+
+    // one call per line, so lines from the two threads never mix
+    printf("%s\n", line);
+    fflush(stdout);
+}
+
+static int searchMain(void* data) {
+    (void)data;
+
+    SearchResult_t result = SearchPosition(&search.board, &search.limits);
+
+    char best[6] = "0000";
+    if(result.best_move != NO_MOVE) MoveToString(result.best_move, best);
+
+    if(result.ponder_move != NO_MOVE) {
+        char ponder[6];
+        MoveToString(result.ponder_move, ponder);
+        printf("bestmove %s ponder %s\n", best, ponder);
+    } else {
+        printf("bestmove %s\n", best);
+    }
+
+    fflush(stdout);
+    return 0;
+}
+
+// the previous go has printed its bestmove once this returns
+static void waitSearch(void) {
+    if(!search.running) return;
+
+    thrd_join(search.thread, NULL);
+    search.running = false;
+}
+
+static void stopSearch(void) {
+    atomic_store(&search.stop, true);
+    waitSearch();
+}
+
+// next whitespace separated word of *cursor, NULL at the end of the line
+static char* nextToken(char** cursor) {
+    char* token = *cursor + strspn(*cursor, " \t\r\n");
+    if(*token == '\0') return NULL;
+
+    char* end = token + strcspn(token, " \t\r\n");
+    if(*end) *end++ = '\0';
+    *cursor = end;
+
+    return token;
+}
+
+static void position(char* args) {
+    char* fen = strstr(args, "fen");
+    char* moves = strstr(args, "moves");
+    if(moves) *moves = '\0';
+
+    if(fen) {
+        fen += 3;
+        fen += strspn(fen, " \t");
+
+        // ParseFen doesn't need the trailing whitespace
+        size_t length = strlen(fen);
+        while(length > 0 && strchr(" \t\r\n", fen[length - 1])) fen[--length] = '\0';
+
+        // parsed aside first, so a bad one leaves the previous position in place
+        FenPosition_t parsed;
+        FenError_t error = ParseFen(fen, length, &parsed, NULL);
+        if(error != FEN_OK) {
+            WARN("Invalid FEN \"%s\": %s, keeping the previous position", fen, FenErrorString(error));
+            return;
+        }
+        InitBoardFromPosition(&board, &parsed);
+    } else if(strstr(args, "startpos")) {
+        InitBoard(&board);
+    } else {
+        return;
+    }
+
+    if(!moves) return;
+
+    char* cursor = moves + strlen("moves") + 1;
+    char* token;
+    while((token = nextToken(&cursor))) {
+        PackedMove_t move = StringToMove(&board, token);
+        if(move == NO_MOVE) {
+            WARN("Illegal move %s in position command, ignoring the rest", token);
+            return;
+        }
+
+        // recorded in History, so the search sees repetitions of the game
+        if(!PlayMove(&board, move)) return;
+    }
+}
+
+// movetime from the clock: a share of what's left plus most of the increment
+static int64_t allocateTime(int64_t time_left, int64_t increment, int moves_to_go) {
+    if(moves_to_go <= 0) moves_to_go = 30;
+
+    int64_t budget = time_left / moves_to_go + increment * 3 / 4;
+    int64_t most = time_left - MOVE_OVERHEAD;
+    if(budget > most) budget = most;
+
+    return budget > 1 ? budget : 1;
+}
+
+// bestmove from the book, false if the position isn't in it
+static bool bookMove(void) {
+    if(!book.enabled || !book.open) return false;
+
+    book.random ^= book.random << 13;
+    book.random ^= book.random >> 7;
+    book.random ^= book.random << 17;
+
+    PackedMove_t move = BookPick(&book.book, &board, book.random);
+    if(move == NO_MOVE) return false;
+
+    char best[6];
+    MoveToString(move, best);
+    printf("bestmove %s\n", best);
+    return true;
+}
+
+static void go(char* args) {
+    stopSearch();
+
+    SearchLimits_t* limits = &search.limits;
+    memset(limits, 0, sizeof(*limits));
+
+    int64_t time[2] = { 0, 0 }, increment[2] = { 0, 0 };
+    int moves_to_go = 0;
+    bool ponder = false;
+
+    char* cursor = args;
+    char* token;
+    while((token = nextToken(&cursor))) {
+        char* value = NULL;
+        if(strcmp(token, "infinite") == 0) limits->infinite = true;
+        else if(strcmp(token, "ponder") == 0) ponder = true;
+        else if(!(value = nextToken(&cursor))) break;
+        else if(strcmp(token, "depth") == 0) limits->depth = atoi(value);
+        else if(strcmp(token, "movetime") == 0) limits->movetime = atoll(value);
+        else if(strcmp(token, "nodes") == 0) limits->nodes = strtoull(value, NULL, 10);
+        else if(strcmp(token, "wtime") == 0) time[WHITE_IDX] = atoll(value);
+        else if(strcmp(token, "btime") == 0) time[BLACK_IDX] = atoll(value);
+        else if(strcmp(token, "winc") == 0) increment[WHITE_IDX] = atoll(value);
+        else if(strcmp(token, "binc") == 0) increment[BLACK_IDX] = atoll(value);
+        else if(strcmp(token, "movestogo") == 0) moves_to_go = atoi(value);
+    }
+
+    if(!limits->infinite && !ponder && bookMove()) return;
+
+    ColorIndex_t us = ColorToIndex(board.turn);
+    if(!limits->movetime && time[us] > 0)
+        limits->movetime = allocateTime(time[us], increment[us], moves_to_go);
+
+    atomic_store(&search.stop, false);
+    atomic_store(&search.ponder, ponder);
+    limits->stop = &search.stop;
+    limits->ponder = ponder ? &search.ponder : NULL;
+    limits->report = reportInfo;
+
+    CopyBoard(&search.board, &board);
+
+    if(thrd_create(&search.thread, searchMain, NULL) != thrd_success) {
+        ERROR("Failed to start the search thread");
+        printf("bestmove 0000\n");
+        fflush(stdout);
+        return;
+    }
+    search.running = true;
+}
+
+static void setOption(char* args) {
+    char* name = strstr(args, "name");
+    char* value = strstr(args, "value");
+    if(!name || !value) return;
+
+    name += strlen("name");
+    name += strspn(name, " \t");
+    *value = '\0';
+    value += strlen("value");
+    value += strspn(value, " \t");
+    value[strcspn(value, "\r\n")] = '\0';
+
+    size_t length = strlen(name);
+    while(length > 0 && strchr(" \t", name[length - 1])) name[--length] = '\0';
+
+    // none of these may change under a running search. GUIs only send setoption while
+    // the engine is idle, but waiting for an infinite or ponder search would never return
+    stopSearch();
+
+    if(strcmp(name, "Hash") == 0) {
+        int mb = atoi(value);
+        if(mb < 1 || mb > MAX_HASH_MB || !TTResize((size_t)mb))
+            WARN("Keeping the %zu MB table", TTSizeMB());
+    } else if(strcmp(name, "Threads") == 0) {
+        int threads = atoi(value);
+        if(threads < 1 || threads > MAX_SEARCH_THREADS || !SetSearchThreads(threads))
+            WARN("Keeping %d search threads", GetSearchThreads());
+    } else if(strcmp(name, "Ponder") == 0) {
+        // nothing to set up, ponder searches come as "go ponder"
+    } else if(strcmp(name, "EvalFile") == 0) {
+        if(*value == '\0' || strcmp(value, "<empty>") == 0) NnueUnload();
+        else NnueLoad(value);
+    } else if(strcmp(name, "OwnBook") == 0) {
+        book.enabled = strcmp(value, "true") == 0;
+    } else if(strcmp(name, "BookFile") == 0) {
+        if(book.open) BookClose(&book.book);
+        book.open = *value != '\0' && strcmp(value, "<empty>") != 0 && BookOpen(value, &book.book);
+    } else if(strcmp(name, "TablebasePath") == 0) {
+        if(*value == '\0' || strcmp(value, "<empty>") == 0) TbClose();
+        else if(TbOpen(value) == 0) WARN("No tablebases in %s", value);
+    } else {
+        WARN("Unknown option %s", name);
+    }
+}
+
+int main(void) {
+    static char line[MAX_LINE];
+
+    InitBoard(&board);
+    book.random = (uint64_t)(NowSeconds() * 1e9) | 1;
+    TTResize(TT_DEFAULT_MB);
+    SetSearchThreads(1);
+
+    while(fgets(line, sizeof(line), stdin)) {
+        char* cursor = line;
+        char* command = nextToken(&cursor);
+        if(!command) continue;
+
+        if(strcmp(command, "uci") == 0) {
+            printf("id name " ENGINE_NAME "\n");
+            printf("id author VideosHosting\n");
+            printf("option name Hash type spin default %d min 1 max %d\n", TT_DEFAULT_MB, MAX_HASH_MB);
+            printf("option name Threads type spin default 1 min 1 max %d\n", MAX_SEARCH_THREADS);
+            printf("option name EvalFile type string default <empty>\n");
+            printf("option name Ponder type check default false\n");
+            printf("option name OwnBook type check default false\n");
+            printf("option name BookFile type string default <empty>\n");
+            printf("option name TablebasePath type string default <empty>\n");
+            printf("uciok\n");
+        } else if(strcmp(command, "isready") == 0) {
+            printf("readyok\n");
+        } else if(strcmp(command, "ucinewgame") == 0) {
+            stopSearch();
+            TTClear();
+        } else if(strcmp(command, "setoption") == 0) {
+            setOption(cursor);
+        } else if(strcmp(command, "position") == 0) {
+            position(cursor);
+        } else if(strcmp(command, "go") == 0) {
+            go(cursor);
+        } else if(strcmp(command, "stop") == 0) {
+            stopSearch();
+        } else if(strcmp(command, "ponderhit") == 0) {
+            atomic_store(&search.ponder, false);
+        } else if(strcmp(command, "quit") == 0) {
+            break;
+        }
+
+        fflush(stdout);
+    }
+
+    stopSearch();
+    FreeSearchThreads();
+    TTFree();
+    NnueUnload();
+    if(book.open) BookClose(&book.book);
+    TbClose();
+    return 0;
+}